@@ -13,39 +13,65 @@
 const char *advection_name[] = { "Upwind", "WENO5", "QUICK", "Semi-Lagrangian", "MacCormack", NULL };
 const char *interp_name[] = { "Linear", "Clamped Cubic Spline", "Monotinic Cubic", NULL };
 const char *integrator_name[] = { "1st Order Euler", "2nd Order Modified Euler", "4th Order Runge-Kutta", NULL };
+const char *layout_name[] = { "Row-Major", "Tiled 8x8", NULL };
+const char *dye_name[] = { "real", "16-bit Fixed", NULL };
 
 // Global References for Instance Access
-static double ***gu = NULL;
-static double **gc = NULL;
+static MACGrid gu;
+static Grid2D gc;
 static int gn = 0;
 static int gcn = 0;
-static double (*interp_func)( double **d, int w, int h, double x, double y ) = NULL;
-
-double monotonic_cubic_4( const double a[4], double x ) {
+static int ginterp = 0;
+static int glayout = LAYOUT_ROW_MAJOR;
+static int gdye = DYE_REAL;
+
+// Scratch Memory ( Carved From The Workspace By advect::bind )
+static MACGrid ku[4];		// Integrator Stages
+static Grid2D kc[4];
+static MACGrid tu;		// Integrator Intermediate State
+static Grid2D tc;
+static Grid2D up[2];		// Velocity At Cell Centers
+static Grid2D ux[2];		// Velocity At X Flow Faces
+static Grid2D uy[2];		// Velocity At Y Flow Faces
+static Grid2D uc[2];		// Velocity At Concentration Cells
+
+// Blocked Copies of The Back-Trace Sources ( LAYOUT_TILED Only )
+static Tiled2D td[3];		// Advected Fields
+static Tiled2D tux[2];
+static Tiled2D tuy[2];
+static Tiled2D tuc[2];
+static Tiled2DT<fixed16> td16;	// 16-bit Dye
+
+// Compact Dye Scratch ( DYE_FIXED16 Only )
+static Grid2D cw;		// Unpacked Dye For Derivative Schemes
+static Grid2D16 c16;		// Back-Traced Dye
+
+real monotonic_cubic_4( const real a[4], real x ) {
 	
-	double d0 = a[1] - a[0];
-	double d1 = a[2] - a[1];
-	double d2 = a[3] - a[2];
+	real d0 = a[1] - a[0];
+	real d1 = a[2] - a[1];
+	real d2 = a[3] - a[2];
 
 	if( ! d1 ) {
 		d0 = d2 = 0.0;
 	} else {
-		double p = d1 > 0.0 ? 1.0 : -1.0;
+		real p = d1 > 0.0 ? 1.0 : -1.0;
 		d0 = p*fabs(d0);
 		d2 = p*fabs(d2);
 	}
 
-	double a3 = d2+d0;
-	double a2 = -d2-2.0*d0;
-	double a1 = d1+d0;
-	double a0 = a[1];
-	double y = a3*x*x*x+a2*x*x+a1*x+a0;
+	real a3 = d2+d0;
+	real a2 = -d2-2.0*d0;
+	real a1 = d1+d0;
+	real a0 = a[1];
+	real y = a3*x*x*x+a2*x*x+a1*x+a0;
 	return y;
 }
 
-double monotonic_cubic( double **d, int width, int height, double x, double y ) {
-	double f[16];
-	double xn[4];
+// NOTICE: d Must Carry a HALO_CLAMP Filled Halo of 3 Cells
+template <class S> real monotonic_cubic( S d, int width, int height, real x, real y ) {
+	real f[16];
+	real xn[4];
 	
 	x = max(0.0,min(width,x));
 	y = max(0.0,min(height,y));
@@ -54,7 +80,7 @@ double monotonic_cubic( double **d, int width, int height, double x, double y )
 		for( int i=0; i<4; i++ ) {
 			int h = (int)x - 1 + i;
 			int v = (int)y - 1 + j;
-			f[4*j+i] = d[min(width-1,max(0,h))][min(height-1,max(0,v))];
+			f[4*j+i] = d(h,v);
 		}
 	}
 	
@@ -65,10 +91,10 @@ double monotonic_cubic( double **d, int width, int height, double x, double y )
 	return monotonic_cubic_4( xn, y - (int)y );
 }
 
-double spline_cubic(const double a[4], double x) {
+real spline_cubic(const real a[4], real x) {
 	int i, j;
-	double alpha[4], l[4], mu[4], z[4];
-	double b[4], c[4], d[4];
+	real alpha[4], l[4], mu[4], z[4];
+	real b[4], c[4], d[4];
 	for(i = 1; i < 3; i++) {
 		alpha[i] = 3.0 * (a[i+1] - a[i]) - 3.0 * (a[i] - a[i-1]);
 	}
@@ -89,14 +115,15 @@ double spline_cubic(const double a[4], double x) {
 		d[j] = (c[j+1] - c[j]) / 3.0;
 	}
 	
-	double minv = min(a[1],a[2]);
-	double maxv = max(a[2],a[1]);
+	real minv = min(a[1],a[2]);
+	real maxv = max(a[2],a[1]);
 	return min(maxv,max(minv,(a[1] + b[1] * x + c[1] * x * x + d[1] * x * x * x )));
 }
 
-double spline_interpolate( double **d, int width, int height, double x, double y ) {
-	double f[16];
-	double xn[4];
+// NOTICE: d Must Carry a HALO_CLAMP Filled Halo of 3 Cells
+template <class S> real spline_interpolate( S d, int width, int height, real x, real y ) {
+	real f[16];
+	real xn[4];
 	
 	x = max(0.0,min(width,x));
 	y = max(0.0,min(height,y));
@@ -105,7 +132,7 @@ double spline_interpolate( double **d, int width, int height, double x, double y
 		for( int i=0; i<4; i++ ) {
 			int h = (int)x - 1 + i;
 			int v = (int)y - 1 + j;
-			f[4*j+i] = d[min(width-1,max(0,h))][min(height-1,max(0,v))];
+			f[4*j+i] = d(h,v);
 		}
 	}
 	
@@ -116,60 +143,71 @@ double spline_interpolate( double **d, int width, int height, double x, double y
 	return spline_cubic( xn, y - (int)y );
 }
 
-static double linear_interpolate ( double **d, int width, int height, double x, double y ) {
+template <class S> static real linear_interpolate ( S d, int width, int height, real x, real y ) {
 	x = max(0.0,min(width,x));
 	y = max(0.0,min(height,y));
 	int i = min(x,width-2);
 	int j = min(y,height-2);
 	
-	return ((i+1-x)*d[i][j]+(x-i)*d[i+1][j])*(j+1-y) + ((i+1-x)*d[i][j+1]+(x-i)*d[i+1][j+1])*(y-j);
+	return ((i+1-x)*d(i,j)+(x-i)*d(i+1,j))*(j+1-y) + ((i+1-x)*d(i,j+1)+(x-i)*d(i+1,j+1))*(y-j);
 }
 
-inline double square(double x) {
+// Interpolant Chosen By ginterp, Instanced For Each Source Layout
+template <class S> struct Interp {
+	typedef real (*Func)( S d, int width, int height, real x, real y );
+};
+
+template <class S> static typename Interp<S>::Func interp_func() {
+	if( ginterp == 0 ) {
+		return linear_interpolate<S>;
+	} else if( ginterp == 1 ) {
+		return spline_interpolate<S>;
+	} else {
+		return monotonic_cubic<S>;
+	}
+}
+
+inline real square(real x) {
 	return x*x;
 }
 
 // WENO5 Advection
-static double weno5calc( double v1, double v2, double v3, double v4, double v5 ) {
-	double e = 1.0e-6;
-	double r1 = 13.0 * square(v1-2.0*v2+v3) / 12.0 + square(v1-4.0*v2+3.0*v3) / 4.0;
-	double r2 = 13.0 * square(v2-2.0*v3+v4) / 12.0 + square(v2-v4) / 4.0;
-	double r3 = 13.0 * square(v3-2.0*v4+v5) / 12.0 + square(3.0*v3-4.0*v4+v5) / 4.0;
-	double w1 = 0.1 / square(e+r1);
-	double w2 = 0.6 / square(e+r2);
-	double w3 = 0.3 / square(e+r3);
-	double s = w1+w2+w3;
+static real weno5calc( real v1, real v2, real v3, real v4, real v5 ) {
+	real e = 1.0e-6;
+	real r1 = 13.0 * square(v1-2.0*v2+v3) / 12.0 + square(v1-4.0*v2+3.0*v3) / 4.0;
+	real r2 = 13.0 * square(v2-2.0*v3+v4) / 12.0 + square(v2-v4) / 4.0;
+	real r3 = 13.0 * square(v3-2.0*v4+v5) / 12.0 + square(3.0*v3-4.0*v4+v5) / 4.0;
+	real w1 = 0.1 / square(e+r1);
+	real w2 = 0.6 / square(e+r2);
+	real w3 = 0.3 / square(e+r3);
+	real s = w1+w2+w3;
 	w1 = w1 / s;
 	w2 = w2 / s;
 	w3 = w3 / s;
 	return (w1*(2.0*v1-7.0*v2+11.0*v3)+w2*(-v2+5.0*v3+2.0*v4)+w3*(2.0*v3+5.0*v4-v5))/6.0;
 }
-static double weno5( double u, double d0, double d1, double d2, double d3, double d4, double d5, double d6) {
+static real weno5( real u, real d0, real d1, real d2, real d3, real d4, real d5, real d6) {
 	return -u*((u>0)*weno5calc(d1-d0,d2-d1,d3-d2,d4-d3,d5-d4)+(u<0)*weno5calc(d6-d5,d5-d4,d4-d3,d3-d2,d2-d1));
 }
 
-static double QUICK( double u, double d0, double d1, double d2, double d3, double d4 ) {
-	double center = 0.5*(d3-d1);
+static real QUICK( real u, real d0, real d1, real d2, real d3, real d4 ) {
+	real center = 0.5*(d3-d1);
 	return -u*(center+(u>0)*(d4-3.0*d3+3.0*d2-d1)/8.0 + (u<0)*(d3-3.0*d2+3.0*d1-d0)/8.0);
 }
 
-// Clamped Fluid Flow Fetch
-static double u_ref( int dir, int i, int j ) {
-	if( dir == 0 )
-		return gu[0][max(0,min(gn,i))][max(0,min(gn-1,j))];
-	else
-		return gu[1][max(0,min(gn-1,i))][max(0,min(gn,j))];
+// Fluid Flow Fetch ( Clamped By The Halo )
+static inline real u_ref( int dir, int i, int j ) {
+	return gu[dir][i][j];
 }
 
-// Clamped Concentration Fetch
-static double c_ref( int i, int j ) {
-	if( i < 0 || i > gcn-1 || j < 0 || j > gcn-1 ) return 0.0;
+// Concentration Fetch ( Zero Outside By The Halo )
+static inline real c_ref( int i, int j ) {
 	return gc[i][j];
 }
 
 // 1D Derivative Advection
-static double advdiff( int method, double u, double d0, double d1, double d2, double d3, double d4, double d5, double d6) {
-	double dd = 0.0;
+static real advdiff( int method, real u, real d0, real d1, real d2, real d3, real d4, real d5, real d6) {
+	real dd = 0.0;
 	switch( method ) {
 		case 0: // Upwind
 			dd = -u*((u>0)*(d3-d2)+(u<0)*(d4-d3));
@@ -185,12 +223,11 @@ static double advdiff( int method, double u, double d0, double d1, double d2, do
 }
 
 // 2D Derivative Advection
-static void advect_diff( int method, double ***u, double **c, int n, int cn, double **out[3], double dt ) {
-	static double **up[2] = { alloc2D(n), alloc2D(n) };
+static void advect_diff( int method, MACGrid u, Grid2D c, int n, int cn, MACGrid out, Grid2D outc, double dt ) {
 	
 	// Advect X Flow
 	OPENMP_FOR FOR_EVERY_X_FLOW(n) {
-		double v[2] = { u[0][i][j], (u_ref(1,i-1,j)+u_ref(1,i,j)+u_ref(1,i-1,j+1)+u_ref(1,i,j+1))/4.0 };
+		real v[2] = { u[0][i][j], (u_ref(1,i-1,j)+u_ref(1,i,j)+u_ref(1,i-1,j+1)+u_ref(1,i,j+1))/4.0 };
 		
 		out[0][i][j] = 0.0;
 		
@@ -205,7 +242,7 @@ static void advect_diff( int method, double ***u, double **c, int n, int cn, dou
 	
 	// Advect Y Flow
 	OPENMP_FOR FOR_EVERY_Y_FLOW(n) {
-		double v[2] = { (u_ref(0,i,j-1)+u_ref(0,i,j)+u_ref(0,i+1,j)+u_ref(0,i+1,j-1))/4.0, u[1][i][j] };
+		real v[2] = { (u_ref(0,i,j-1)+u_ref(0,i,j)+u_ref(0,i+1,j)+u_ref(0,i+1,j-1))/4.0, u[1][i][j] };
 		
 		out[1][i][j] = 0.0;
 		
@@ -221,37 +258,45 @@ static void advect_diff( int method, double ***u, double **c, int n, int cn, dou
 	
 	// Advect Concentration
 	OPENMP_FOR FOR_EVERY_CELL(n) {
-		up[0][i][j] = 0.5*u[0][i][j]+0.5*u[0][i+1][j];
-		up[1][i][j] = 0.5*u[1][i][j]+0.5*u[1][i][j+1];
+		up[0][i][j] = u.centerX(i,j);
+		up[1][i][j] = u.centerY(i,j);
 	} END_FOR
 	
 	OPENMP_FOR FOR_EVERY_CELL(cn) {
-		double x = i*n/(double)cn;
-		double y = j*n/(double)cn;
-		double v[2] = { linear_interpolate( up[0], n, n, x, y ), linear_interpolate( up[1], n, n, x, y ) };
+		real x = i*n/(double)cn;
+		real y = j*n/(double)cn;
+		real v[2] = { linear_interpolate( up[0], n, n, x, y ), linear_interpolate( up[1], n, n, x, y ) };
 
-		out[2][i][j] = 0.0;
+		outc[i][j] = 0.0;
 		
 		// X Direction
-		out[2][i][j] += advdiff( method, v[0], c_ref(i-3,j), c_ref(i-2,j), c_ref(i-1,j), c_ref(i,j), 
+		outc[i][j] += advdiff( method, v[0], c_ref(i-3,j), c_ref(i-2,j), c_ref(i-1,j), c_ref(i,j), 
 								c_ref(i+1,j), c_ref(i+2,j), c_ref(i+3,j) ) * cn;
 		
 		// Y Direction
-		out[2][i][j] += advdiff( method, v[1], c_ref(i,j-3), c_ref(i,j-2), c_ref(i,j-1), c_ref(i,j), 
+		outc[i][j] += advdiff( method, v[1], c_ref(i,j-3), c_ref(i,j-2), c_ref(i,j-1), c_ref(i,j), 
 								c_ref(i,j+1), c_ref(i,j+2), c_ref(i,j+3) ) * cn;
 		
 	} END_FOR
 }
 
-static void maccormack ( double **d, double **d0, int width, int height, double ***u, float dt )
+// Store Into The Output Grid ( Packed When It Is 16-bit )
+static inline void store( Grid2D d, int i, int j, real v ) {
+	d[i][j] = v;
+}
+
+static inline void store( Grid2D16 d, int i, int j, real v ) {
+	d[i][j] = toFixed16(v);
+}
+
+// d0 And u Are Gather Sources, S And V Are Their Layouts, D Is The Output Grid
+template <class D, class S, class V> static void maccormack ( D d, S d0, int width, int height, V *u, float dt )
 {
-	OPENMP_FOR
-	for( int n=0; n<width*height; n++ ) {
-		int i = n%width;
-		int j = n/width;
-		
-		double x = min(width-1,max(0.0,i-dt*gn*u[0][i][j]));
-		double y = min(height-1,max(0.0,j-dt*gn*u[1][i][j]));
+	typename Interp<S>::Func interp = interp_func<S>();
+	typename Interp<V>::Func interp_u = interp_func<V>();
+	OPENMP_FOR FOR_EVERY_RANGE(width,height) {
+		real x = min(width-1,max(0.0,i-dt*gn*u[0](i,j)));
+		real y = min(height-1,max(0.0,j-dt*gn*u[1](i,j)));
 		
 		int i0 = min(width-2,max(0,(int)x));
 		int j0 = min(height-2,max(0,(int)y));
@@ -259,37 +304,84 @@ static void maccormack ( double **d, double **d0, int width, int height, double
 		int i1 = i0+1;
 		int j1 = j0+1;
 		
-		double phi_n_1_hat = interp_func( d0, width, height, x, y );
-		double u_hat = interp_func( u[0], width, height, x, y );
-		double v_hat = interp_func( u[1], width, height, x, y );
+		real phi_n_1_hat = interp( d0, width, height, x, y );
+		real u_hat = interp_u( u[0], width, height, x, y );
+		real v_hat = interp_u( u[1], width, height, x, y );
 		
 		x += dt*gn*u_hat;
 		y += dt*gn*v_hat;
 		
-		double phi_n_hat = interp_func( d0, width, height, x, y );
+		real phi_n_hat = interp( d0, width, height, x, y );
 		
-		double min_phi = min( min( min( d0[i0][j0], d0[i1][j0] ), d0[i0][j1] ), d0[i1][j1] );
-		double max_phi = max( max( max( d0[i0][j0], d0[i1][j0] ), d0[i0][j1] ), d0[i1][j1] );
-		double r = phi_n_1_hat + 0.5*( d0[i][j] - phi_n_hat);
+		real min_phi = min( min( min( d0(i0,j0), d0(i1,j0) ), d0(i0,j1) ), d0(i1,j1) );
+		real max_phi = max( max( max( d0(i0,j0), d0(i1,j0) ), d0(i0,j1) ), d0(i1,j1) );
+		real r = phi_n_1_hat + 0.5*( d0(i,j) - phi_n_hat);
 		
-		d[i][j] = max( min(r, max_phi), min_phi );
-	}
+		store( d, i, j, max( min(r, max_phi), min_phi ) );
+	} END_FOR
+}
+
+// d0 Is The Gather Source, S Is Its Layout ( u Is Only Read In Place ), D Is The Output Grid
+template <class D, class S> static void semiLagrangian( D d, S d0, int width, int height, Grid2D *u, float dt ) {
+	typename Interp<S>::Func interp = interp_func<S>();
+	OPENMP_FOR FOR_EVERY_RANGE(width,height) {
+		store( d, i, j, interp( d0, width, height, i-gn*u[0][i][j]*dt, j-gn*u[1][i][j]*dt ) );
+	} END_FOR
 }
 
-static void semiLagrangian( double **d, double **d0, int width, int height, double ***u, float dt ) {
-	OPENMP_FOR
-	for( int n=0; n<width*height; n++ ) {
-		int i = n%width;
-		int j = n/width;
-		d[i][j] = interp_func( d0, width, height, i-gn*u[0][i][j]*dt, j-gn*u[1][i][j]*dt );
+// Back-Trace All Fields: The Flows From d0 And The Dye From c0 Into dye
+// vx, vy, vc Are The Velocities In Layout S ( MacCormack Gathers Them Too )
+template <class S, class C, class D> static void backTrace( int order, MACGrid out, D dye, S d0[2], C c0,
+														   S vx[2], S vy[2], S vc[2], int n, int cn, double dt ) {
+	
+	// 1st Order Semi Advection
+	if( order == 1 ) {
+		// BackTrace X Flow
+		semiLagrangian( out[0], d0[0], n+1, n, ux, dt );
+
+		// BackTrace Y Flow
+		semiLagrangian( out[1], d0[1], n, n+1, uy, dt );
+			
+		// BackTrace Concentration
+		semiLagrangian( dye, c0, cn, cn, uc, dt );
+		
+	// 2nd Order MacCormack Method
+	} else if( order == 2 ) {
+		// BackTrace X Flow
+		maccormack( out[0], d0[0], n+1, n, vx, dt );
+		
+		// BackTrace Y Flow
+		maccormack( out[1], d0[1], n, n+1, vy, dt );
+		
+		// BackTrace Concentration
+		maccormack( dye, c0, cn, cn, vc, dt );	
 	}
 }
 
+// Dye Gather Source For Each Storage And Layout
+static Grid2D rowSource( Grid2D c ) {
+	return c;
+}
+
+static Fixed16<Grid2D16> rowSource( Grid2D16 c ) {
+	Fixed16<Grid2D16> src = { c };
+	return src;
+}
+
+static Tiled2D tiledSource( Grid2D c ) {
+	tile2D(td[2],c);
+	return td[2];
+}
+
+static Fixed16<Tiled2DT<fixed16> > tiledSource( Grid2D16 c ) {
+	tile2D(td16,c);
+	Fixed16<Tiled2DT<fixed16> > src = { td16 };
+	return src;
+}
+
 // Semi-Lagrangian Advection Method
-static void advect_semiLagrangian( int method, double ***u, double **c, int n, int cn, double **out[3], double dt ) {
-	
-	double h = 1.0/n;
-	double ch = 1.0/cn;
+// Flows Go To out, The Dye c ( real Or 16-bit ) Goes To dye
+template <class C, class D> static void advect_semiLagrangian( int method, MACGrid u, C c, int n, int cn, MACGrid out, D dye, double dt ) {
 	
 	// BackTrace Order
 	int order = 1;
@@ -303,16 +395,11 @@ static void advect_semiLagrangian( int method, double ***u, double **c, int n, i
 		case 4:
 			// 2nd Order MacCormack Advection
 			order = 2;
-			interp_func = spline_interpolate;
+			ginterp = 1;
 			break;
 	}
 	
 	// Compute Fluid Velocity At Each Staggered Faces And Concentration Cell Centers
-	static double **ux[2] = { alloc2D(n+1), alloc2D(n+1) };
-	static double **uy[2] = { alloc2D(n+1), alloc2D(n+1) };
-	static double **up[2] = { alloc2D(n), alloc2D(n) };
-	static double **uc[2] = { alloc2D(cn), alloc2D(cn) };
-	
 	OPENMP_FOR FOR_EVERY_X_FLOW(n) {
 		ux[0][i][j] = u[0][i][j];
 		ux[1][i][j] = (u_ref(1,i-1,j)+u_ref(1,i,j)+u_ref(1,i-1,j+1)+u_ref(1,i,j+1))/4.0;
@@ -324,168 +411,198 @@ static void advect_semiLagrangian( int method, double ***u, double **c, int n, i
 	} END_FOR
 	
 	OPENMP_FOR FOR_EVERY_CELL(n) {
-		up[0][i][j] = 0.5*u[0][i][j]+0.5*u[0][i+1][j];
-		up[1][i][j] = 0.5*u[1][i][j]+0.5*u[1][i][j+1];
+		up[0][i][j] = u.centerX(i,j);
+		up[1][i][j] = u.centerY(i,j);
 	} END_FOR
+	fillHalo(up[0],n,n,HALO_CLAMP);
+	fillHalo(up[1],n,n,HALO_CLAMP);
 	
+	Interp<Grid2D>::Func interp = interp_func<Grid2D>();
 	OPENMP_FOR FOR_EVERY_CELL(cn) {
-		double x = i*n/(double)cn;
-		double y = j*n/(double)cn;
-		uc[0][i][j] = interp_func( up[0], n, n, x, y );
-		uc[1][i][j] = interp_func( up[1], n, n, x, y );
+		real x = i*n/(double)cn;
+		real y = j*n/(double)cn;
+		uc[0][i][j] = interp( up[0], n, n, x, y );
+		uc[1][i][j] = interp( up[1], n, n, x, y );
 	} END_FOR
+	
+	// Back-Traces Interpolate These Velocities Too
+	for( int dim=0; dim<2; dim++ ) {
+		fillHalo(ux[dim],n+1,n,HALO_CLAMP);
+		fillHalo(uy[dim],n,n+1,HALO_CLAMP);
+		fillHalo(uc[dim],cn,cn,HALO_CLAMP);
+	}
 
-	// 1st Order Semi Advection
-	if( order == 1 ) {
-		// BackTrace X Flow
-		semiLagrangian( out[0], u[0], n+1, n, ux, dt );
-
-		// BackTrace Y Flow
-		semiLagrangian( out[1], u[1], n, n+1, uy, dt );
-			
-		// BackTrace Concentration
-		semiLagrangian( out[2], c, cn, cn, uc, dt );
-		
-	// 2nd Order MacCormack Method
-	} else if( order == 2 ) {
-		// BackTrace X Flow
-		maccormack( out[0], u[0], n+1, n, ux, dt );
-		
-		// BackTrace Y Flow
-		maccormack( out[1], u[1], n, n+1, uy, dt );
-		
-		// BackTrace Concentration
-		maccormack( out[2], c, cn, cn, uc, dt );	
+	// Gather From Blocked Copies ( Halos Above Are Copied Along )
+	if( glayout == LAYOUT_TILED ) {
+		tile2D(td[0],u[0]);
+		tile2D(td[1],u[1]);
+		if( order == 2 ) {
+			for( int dim=0; dim<2; dim++ ) {
+				tile2D(tux[dim],ux[dim]);
+				tile2D(tuy[dim],uy[dim]);
+				tile2D(tuc[dim],uc[dim]);
+			}
+		}
+		backTrace( order, out, dye, td, tiledSource(c), tux, tuy, tuc, n, cn, dt );
+	} else {
+		Grid2D d0[2] = { u[0], u[1] };
+		backTrace( order, out, dye, d0, rowSource(c), ux, uy, uc, n, cn, dt );
 	}
 }
 
-static double advect_step( int method, double ***u, double **c, int n, int cn, double ***out, double dt ) {
+static void advect_step( int method, MACGrid u, Grid2D c, int n, int cn, MACGrid out, Grid2D outc, double dt ) {
 	if( method < 3 ) { 
 		// Upwind or WENO5
-		advect_diff(method,u,c,n,cn,out,dt); // Watch for a CFL condition
+		advect_diff(method,u,c,n,cn,out,outc,dt); // Watch for a CFL condition
 	} else {
 		// Semi-lagrangian
-		advect_semiLagrangian(method,u,c,n,cn,out,dt);
+		advect_semiLagrangian(method,u,c,n,cn,out,outc,dt);
 	}
 }
 
-void advect::advect( int method, int interp, int integrator, double ***u, double **c, int n, int cn, double dt ) {
+void advect::bind( Workspace &ws, int n, int cn ) {
+	for( int kn=0; kn<4; kn++ ) {
+		ku[kn] = carveMAC(ws,n);
+		kc[kn] = carve2D(ws,cn);
+	}
+	tu = carveMAC(ws,n);
+	tc = carve2D(ws,cn);
+	for( int dim=0; dim<2; dim++ ) {
+		up[dim] = carve2D(ws,n,ADVECT_HALO);
+		ux[dim] = carve2DT<real>(ws,n+1,n,ADVECT_HALO);
+		uy[dim] = carve2DT<real>(ws,n,n+1,ADVECT_HALO);
+		uc[dim] = carve2D(ws,cn,ADVECT_HALO);
+	}
+	
+	if( gdye == DYE_FIXED16 ) {
+		cw = carve2D(ws,cn,ADVECT_HALO);
+		c16 = carve2DT<fixed16>(ws,cn,cn);
+	}
+	
+	if( glayout == LAYOUT_TILED ) {
+		td[0] = carveTiled2DT<real>(ws,n+1,n,ADVECT_HALO);
+		td[1] = carveTiled2DT<real>(ws,n,n+1,ADVECT_HALO);
+		if( gdye == DYE_REAL ) td[2] = carveTiled2DT<real>(ws,cn,cn,ADVECT_HALO);
+		else td16 = carveTiled2DT<fixed16>(ws,cn,cn,ADVECT_HALO);
+		for( int dim=0; dim<2; dim++ ) {
+			tux[dim] = carveTiled2DT<real>(ws,n+1,n,ADVECT_HALO);
+			tuy[dim] = carveTiled2DT<real>(ws,n,n+1,ADVECT_HALO);
+			tuc[dim] = carveTiled2DT<real>(ws,cn,cn,ADVECT_HALO);
+		}
+	}
+}
+
+void advect::setLayout( int layout ) {
+	glayout = layout;
+}
+
+void advect::setDyeStorage( int storage ) {
+	gdye = storage;
+}
+
+void advect::advect( int method, int interp, int integrator, MACGrid u, Grid2D c, int n, int cn, double dt ) {
 	
 	gu = u;
 	gc = c;
 	gn = n;
 	gcn = cn;
 	
-	double h = 1.0/n;
-	double ch = 1.0/cn;
+	// Fill Halos Once Per Step ( Derivative Schemes See Zero Concentration Outside )
+	fillHalo(u[0],n+1,n,HALO_CLAMP);
+	fillHalo(u[1],n,n+1,HALO_CLAMP);
+	fillHalo(c,cn,cn,method < 3 ? HALO_ZERO : HALO_CLAMP);
 	
-	// Memory Allocation
-	static double **k[4][3] = { NULL, NULL, NULL, NULL };
-	static double **tmp[3] = { alloc2D(n+1), alloc2D(n+1), alloc2D(cn) };
-	for( int kn=0; kn<4; kn++ ) {
-		if( ! k[kn][0] ) k[kn][0] = alloc2D(n+1);
-		if( ! k[kn][1] ) k[kn][1] = alloc2D(n+1);
-		if( ! k[kn][2] ) k[kn][2] = alloc2D(cn);
-	}
+	real h = 1.0/n;
+	real ch = 1.0/cn;
 	
 	// Set Interpolation Method
-	if( interp == 0 ) {
-		interp_func = linear_interpolate;
-	} else if(interp == 1)  {
-		interp_func = spline_interpolate;
-	} else {
-		interp_func = monotonic_cubic;
-	}
+	ginterp = interp;
 	
 	if( method < 3 ) {
 		if( integrator == 0 ) {			// Forward Euler Method
-			advect_step( method, u, c, n, cn, k[0], dt );
+			advect_step( method, u, c, n, cn, ku[0], kc[0], dt );
 			
-			op2D(u[0],u[0],k[0][0],1.0,dt,n+1);
-			op2D(u[1],u[1],k[0][1],1.0,dt,n+1);
-			op2D(c,c,k[0][2],1.0,dt,cn);
+			opMAC(u,u,ku[0],1.0,dt);
+			op2D(c,c,kc[0],1.0,dt,cn);
 			
 		} else if( integrator == 1 ) { // Modified Euler Method
 			// k0 = f'(x)
-			advect_step( method, u, c, n, cn, k[0], dt );
+			advect_step( method, u, c, n, cn, ku[0], kc[0], dt );
 			
 			// k1 = f'(x + k0*dt)
-			op2D(tmp[0], u[0], k[0][0], 1.0, dt, n+1);
-			op2D(tmp[1], u[1], k[0][1], 1.0, dt, n+1);
-			op2D(tmp[2], c,    k[0][2], 1.0, dt, cn);
-			advect_step( method, tmp, tmp[2], n, cn, k[1], dt );
+			opMAC(tu, u, ku[0], 1.0, dt);
+			op2D(tc, c, kc[0], 1.0, dt, cn);
+			advect_step( method, tu, tc, n, cn, ku[1], kc[1], dt );
 			
 			// y = x + 0.5*dt*(k0+k1)
-			op2D(u[0], u[0], k[0][0], 1.0, 0.5*dt, n+1 );
-			op2D(u[1], u[1], k[0][1], 1.0, 0.5*dt, n+1 );
-			op2D(c,    c,    k[0][2], 1.0, 0.5*dt, cn  );
+			opMAC(u, u, ku[0], 1.0, 0.5*dt );
+			op2D(c, c, kc[0], 1.0, 0.5*dt, cn );
 			
-			op2D(u[0], u[0], k[1][0], 1.0, 0.5*dt, n+1 );
-			op2D(u[1], u[1], k[1][1], 1.0, 0.5*dt, n+1 );
-			op2D(c,    c,    k[1][2], 1.0, 0.5*dt, cn  );
+			opMAC(u, u, ku[1], 1.0, 0.5*dt );
+			op2D(c, c, kc[1], 1.0, 0.5*dt, cn );
 			
 		} else if( integrator == 2  ) { // Runge-Kutta Method
 			// k0 = f'(x)
-			advect_step( method, u, c, n, cn, k[0], dt );
+			advect_step( method, u, c, n, cn, ku[0], kc[0], dt );
 			
 			// k1 = f'(x + 0.5*k0*dt)
-			op2D(tmp[0], u[0], k[0][0], 1.0, 0.5*dt, n+1);
-			op2D(tmp[1], u[1], k[0][1], 1.0, 0.5*dt, n+1);
-			op2D(tmp[2], c,    k[0][2], 1.0, 0.5*dt, cn);
-			advect_step( method, tmp, tmp[2], n, cn, k[1], dt );
+			opMAC(tu, u, ku[0], 1.0, 0.5*dt);
+			op2D(tc, c, kc[0], 1.0, 0.5*dt, cn);
+			advect_step( method, tu, tc, n, cn, ku[1], kc[1], dt );
 			
 			// k2 = f'(x + 0.5*k1*dt)
-			op2D(tmp[0], u[0], k[1][0], 1.0, 0.5*dt, n+1);
-			op2D(tmp[1], u[1], k[1][1], 1.0, 0.5*dt, n+1);
-			op2D(tmp[2], c,    k[1][2], 1.0, 0.5*dt, cn);
-			advect_step( method, tmp, tmp[2], n, cn, k[2], dt );
+			opMAC(tu, u, ku[1], 1.0, 0.5*dt);
+			op2D(tc, c, kc[1], 1.0, 0.5*dt, cn);
+			advect_step( method, tu, tc, n, cn, ku[2], kc[2], dt );
 			
 			// k3 = f'(x + 0.5*k2*dt)
-			op2D(tmp[0], u[0], k[2][0], 1.0, dt, n+1);
-			op2D(tmp[1], u[1], k[2][1], 1.0, dt, n+1);
-			op2D(tmp[2], c,    k[2][2], 1.0, dt, cn);
-			advect_step( method, tmp, tmp[2], n, cn, k[3], dt );
+			opMAC(tu, u, ku[2], 1.0, dt);
+			op2D(tc, c, kc[2], 1.0, dt, cn);
+			advect_step( method, tu, tc, n, cn, ku[3], kc[3], dt );
 			
 			// y = x + dt*(k0+2*k1+2*k2+k3)/6
-			op2D(u[0], u[0], k[0][0], 1.0, dt/6.0, n+1 );
-			op2D(u[1], u[1], k[0][1], 1.0, dt/6.0, n+1 );
-			op2D(c,    c,    k[0][2], 1.0, dt/6.0, cn  );
+			opMAC(u, u, ku[0], 1.0, dt/6.0 );
+			op2D(c, c, kc[0], 1.0, dt/6.0, cn );
 			
-			op2D(u[0], u[0], k[1][0], 1.0, dt/3.0, n+1 );
-			op2D(u[1], u[1], k[1][1], 1.0, dt/3.0, n+1 );
-			op2D(c,    c,    k[1][2], 1.0, dt/3.0, cn  );
+			opMAC(u, u, ku[1], 1.0, dt/3.0 );
+			op2D(c, c, kc[1], 1.0, dt/3.0, cn );
 			
-			op2D(u[0], u[0], k[2][0], 1.0, dt/3.0, n+1 );
-			op2D(u[1], u[1], k[2][1], 1.0, dt/3.0, n+1 );
-			op2D(c,    c,    k[2][2], 1.0, dt/3.0, cn  );
+			opMAC(u, u, ku[2], 1.0, dt/3.0 );
+			op2D(c, c, kc[2], 1.0, dt/3.0, cn );
 			
-			op2D(u[0], u[0], k[3][0], 1.0, dt/6.0, n+1 );
-			op2D(u[1], u[1], k[3][1], 1.0, dt/6.0, n+1 );
-			op2D(c,    c,    k[3][2], 1.0, dt/6.0, cn  );
+			opMAC(u, u, ku[3], 1.0, dt/6.0 );
+			op2D(c, c, kc[3], 1.0, dt/6.0, cn );
 		}
 	} else {
-		advect_step( method, u, c, n, cn, k[0], dt );
-		copy2D(u[0],k[0][0],n+1);
-		copy2D(u[1],k[0][1],n+1);
-		copy2D(c,k[0][2],cn);
+		advect_step( method, u, c, n, cn, ku[0], kc[0], dt );
+		copyMAC(u,ku[0]);
+		copy2D(c,kc[0],cn);
 	}
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+void advect::advect( int method, int interp, int integrator, MACGrid u, Grid2D16 c, int n, int cn, double dt ) {
+	
+	// Derivative Schemes Run On An Unpacked Copy
+	if( method < 3 ) {
+		unpack16(cw,c,cn,cn);
+		advect(method,interp,integrator,u,cw,n,cn,dt);
+		pack16(c,cw,cn,cn);
+		return;
+	}
+	
+	gu = u;
+	gn = n;
+	gcn = cn;
+	
+	fillHalo(u[0],n+1,n,HALO_CLAMP);
+	fillHalo(u[1],n,n+1,HALO_CLAMP);
+	fillHalo(c,cn,cn,HALO_CLAMP);
+	ginterp = interp;
+	
+	// Back-Trace Gathers The Packed Dye And Stores It Packed
+	advect_semiLagrangian( method, u, c, n, cn, ku[0], c16, dt );
+	copyMAC(u,ku[0]);
+	OPENMP_FOR FOR_EVERY_CELL(cn) {
+		c[i][j] = c16[i][j];
+	} END_FOR
+}
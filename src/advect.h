@@ -21,8 +21,16 @@
 // 1: Modified Euler
 // 2: Runge-Kutta
 
+// Layout ( Storage of The Semi-Lagrangian / MacCormack Gather Sources ):
+// 0: Row-Major
+// 1: Tiled 8x8 Blocks
+
+// Dye Storage:
+// 0: real
+// 1: 16-bit Fixed Point ( See FIXED16_SCALE )
+
 // u:
-// Staggered Velocity Field
+// Staggered ( MAC ) Velocity Field
 
 // n:
 // Size of Velocity Field Grid Size
@@ -33,10 +41,33 @@
 // dt:
 // Timestep Stride
 
+#include "utility.h"
+
+// Ghost Cells Needed Around u And c ( WENO5 Reaches 3 Cells )
+#define ADVECT_HALO		3
+
+#define DYE_REAL		0
+#define DYE_FIXED16		1
+
 extern const char *advection_name[];
 extern const char *interp_name[];
 extern const char *integrator_name[];
+extern const char *layout_name[];
+extern const char *dye_name[];
 
 namespace advect {
-	void advect( int method, int interp, int integrator, double ***u, double **c, int n, int cn, double dt );
+	// Choose LAYOUT_ROW_MAJOR Or LAYOUT_TILED ( Call Before bind )
+	void setLayout( int layout );
+	
+	// Choose DYE_REAL Or DYE_FIXED16 ( Call Before bind )
+	void setDyeStorage( int storage );
+	
+	// Carve Scratch Memory For Velocity Grid Size n And Concentration Grid Size cn
+	void bind( Workspace &ws, int n, int cn );
+	
+	// NOTICE: u And c Must Carry a Halo of ADVECT_HALO Cells ( u Is Updated In Place )
+	void advect( int method, int interp, int integrator, MACGrid u, Grid2D c, int n, int cn, double dt );
+	
+	// Same With The Dye Stored As 16-bit Fixed Point ( Needs DYE_FIXED16 )
+	void advect( int method, int interp, int integrator, MACGrid u, Grid2D16 c, int n, int cn, double dt );
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "smoke2D.h"
+#include "simd.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #if defined(__APPLE__) || defined(MACOSX)
 #include <GLUT/glut.h>
 #include <OpenGL/gl.h>
@@ -27,6 +29,11 @@ static void display(void) {
 
 static void init( int gsize ) {
 	glClearColor(0.0, 0.0, 0.0, 1.0);
+	
+	// Turn On Blending
+	glEnable(GL_BLEND);
+	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	
 	smoke2D::init(gsize);
 }
 
@@ -69,9 +76,62 @@ int main (int argc, char * argv[]) {
 	int grid_size = 64;
 #endif
 	
-	if( argc == 2  ) {
+	// -tiled Anywhere Stores The Semi-Lagrangian Gather Sources In Blocks
+	// -dye16 Anywhere Stores The Dye As 16-bit Fixed Point
+	// -warm / -extrap Anywhere Start Each Pressure Solve From The Last Frame(s)
+	// -log Anywhere Prints Every Pressure Solve
+	// -smoother 2 Anywhere Picks The Multigrid Smoother ( Numbers In solver.h )
+	// -tol 1e-5 / -maxtime 10 Anywhere Set The Relative Residual / Milliseconds of Each Pressure Solve
+	// -simd 2 Anywhere Caps The Vector Kernels ( Levels In simd.h, Default: Widest The CPU Runs )
+	double value;
+	int smoother;
+	int simd_limit = -1;
+	for( int n=1; n<argc; n++ ) {
+		int option = 1;
+		if( ! strcmp(argv[n],"-tiled") ) smoke2D::setLayout(1);
+		else if( ! strcmp(argv[n],"-dye16") ) smoke2D::setDyeStorage(1);
+		else if( ! strcmp(argv[n],"-warm") ) smoke2D::setWarmStart(WARM_PREVIOUS);
+		else if( ! strcmp(argv[n],"-extrap") ) smoke2D::setWarmStart(WARM_EXTRAPOLATE);
+		else if( ! strcmp(argv[n],"-log") ) smoke2D::setLogging(true);
+		else if( ! strcmp(argv[n],"-smoother") && n+1 < argc && sscanf(argv[n+1],"%d",&smoother) == 1 ) {
+			smoke2D::setSmoother(smoother);
+			option = 2;
+		}
+		else if( ! strcmp(argv[n],"-tol") && n+1 < argc && sscanf(argv[n+1],"%lf",&value) == 1 ) {
+			smoke2D::setTolerance(value);
+			option = 2;
+		}
+		else if( ! strcmp(argv[n],"-maxtime") && n+1 < argc && sscanf(argv[n+1],"%lf",&value) == 1 ) {
+			smoke2D::setTimeBudget(value);
+			option = 2;
+		}
+		else if( ! strcmp(argv[n],"-simd") && n+1 < argc && sscanf(argv[n+1],"%d",&simd_limit) == 1 ) {
+			option = 2;
+		}
+		else option = 0;
+		if( option ) {
+			for( int m=n; m<argc-option; m++ ) argv[m] = argv[m+option];
+			argc -= option;
+			n --;
+		}
+	}
+	
+	if( argc >= 2  ) {
 		sscanf( argv[1], "%d", &grid_size );
 	}
+	simd::init(simd_limit);
+	
+	// ./smoke 256 -bench [steps] [solver] [advection]
+	if( argc >= 3 && ! strcmp(argv[2],"-bench") ) {
+		int steps = 100;
+		int solver = -1;
+		int advection = -1;
+		if( argc >= 4 ) sscanf( argv[3], "%d", &steps );
+		if( argc >= 5 ) sscanf( argv[4], "%d", &solver );
+		if( argc >= 6 ) sscanf( argv[5], "%d", &advection );
+		smoke2D::benchmark( grid_size, steps, solver, advection );
+		return 0;
+	}
 	
 	glutInit(&argc, argv);
 	glutInitDisplayMode(GLUT_RGBA | GL_DOUBLE);
@@ -0,0 +1,462 @@
+/*
+ *  simd.cpp
+ *  smoke
+ *
+ */
+
+#include "simd.h"
+#include <stdio.h>
+#include <string.h>
+
+const char *simd_name[] = { "Scalar", "SSE2", "AVX2", "AVX-512", NULL };
+
+// Self-Test Row Length ( Odd, So Every Path Also Runs Its Scalar Tail )
+#define SIMD_TEST_N		77
+
+// Allowed Relative Difference From The Scalar Path ( Only The Dot Product Sums In a Different Order )
+#define SIMD_TOLERANCE	(sizeof(real) == sizeof(float) ? 1e-5 : 1e-12)
+
+// Reference Loops ( Also The Fallback ), In Either Precision
+namespace scalar {
+	template <class T> static void laplacian( T *a, const T *xm, const T *x0, const T *xp, T h2, int n ) {
+		for( int j=0; j<n; j++ ) a[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+	}
+
+	template <class T> static void residual( T *r, const T *b, const T *xm, const T *x0, const T *xp, T h2, int n ) {
+		for( int j=0; j<n; j++ ) r[j] = b[j]-(xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+	}
+
+	template <class T> static void relax( T *x0, const T *xm, const T *xp, const T *b, T h2, int from, int to, int parity ) {
+		for( int j=from+((from^parity)&1); j<to; j+=2 ) {
+			x0[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-h2*b[j]) / 4;
+		}
+	}
+
+	template <class T> static double dot( const T *x, const T *y, int n ) {
+		double ans = 0.0;
+		for( int j=0; j<n; j++ ) ans += x[j]*y[j];
+		return ans;
+	}
+
+	template <class T> static void axpy( T *ans, const T *x, const T *y, T a, int n ) {
+		for( int j=0; j<n; j++ ) ans[j] = x[j]+a*y[j];
+	}
+
+	template <class T> static void combine( T *dst, const T *x, const T *y, T a, T b, int n ) {
+		for( int j=0; j<n; j++ ) dst[j] = a*x[j]+b*y[j];
+	}
+
+	template <class T> static void divergence( T *d, const T *ux0, const T *ux1, const T *uy, T h, int n ) {
+		for( int j=0; j<n; j++ ) d[j] = ((ux1[j]-ux0[j]) + (uy[j+1]-uy[j]))/h;
+	}
+
+	template <class T> static void gradient( T *u, const T *p0, const T *p1, T h, int n ) {
+		for( int j=0; j<n; j++ ) u[j] -= (p1[j]-p0[j])/h;
+	}
+
+	static const simd::Kernels kernels = { laplacian<real>, residual<real>, relax<real>, dot<real>, axpy<real>, combine<real>,
+										   divergence<real>, gradient<real> };
+#ifndef USE_FLOAT
+	static const simd::KernelsT<float> kernels_f = { laplacian<float>, residual<float>, relax<float>, dot<float>, axpy<float>,
+													 combine<float>, divergence<float>, gradient<float> };
+#endif
+}
+
+// x86 Paths Need GCC Or Clang ( Per Function Targets And __builtin_cpu_supports )
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#endif
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+
+// Compile What Follows For One Instruction Set ( The Rest of The Binary Stays Generic )
+#define SIMD_PRAGMA(...)		_Pragma(#__VA_ARGS__)
+#if defined(__clang__)
+#define SIMD_TARGET_BEGIN(isa)	SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))),apply_to=function))
+#define SIMD_TARGET_END			SIMD_PRAGMA(clang attribute pop)
+#else
+#define SIMD_TARGET_BEGIN(isa)	SIMD_PRAGMA(GCC push_options) SIMD_PRAGMA(GCC target(isa))
+#define SIMD_TARGET_END			SIMD_PRAGMA(GCC pop_options)
+#endif
+
+// Vector Traits: W Lanes of real, a Lane Mask For One Color, And a double Accumulator
+// One Namespace Per Precision Whose real Is That Precision: f, And d In The double Build
+SIMD_TARGET_BEGIN("sse2")
+namespace sse2 {
+	namespace f {
+	typedef float real;
+	struct V {
+		typedef __m128 vec;
+		typedef __m128 mask;
+		enum { W = 4 };
+		static inline vec load( const real *p ) { return _mm_loadu_ps(p); }
+		static inline void store( real *p, vec a ) { _mm_storeu_ps(p,a); }
+		static inline vec set1( real a ) { return _mm_set1_ps(a); }
+		static inline vec add( vec a, vec b ) { return _mm_add_ps(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm_sub_ps(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm_mul_ps(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm_div_ps(a,b); }
+		static inline mask alternate( int first ) {
+			return _mm_castsi128_ps(first ? _mm_set_epi32(-1,0,-1,0) : _mm_set_epi32(0,-1,0,-1));
+		}
+		// ( a[W-1], b[0], ..., b[W-2] )
+		static inline vec left( vec a, vec b ) {
+			vec t = _mm_shuffle_ps(a,b,_MM_SHUFFLE(0,0,3,3));
+			return _mm_shuffle_ps(t,b,_MM_SHUFFLE(2,1,2,0));
+		}
+		// No Masked Store Before AVX: The Other Lanes Get Back What Was Loaded
+		static inline void storeSome( real *p, mask m, vec a, vec old ) {
+			_mm_storeu_ps(p,_mm_or_ps(_mm_and_ps(m,a),_mm_andnot_ps(m,old)));
+		}
+		typedef __m128d sum;
+		static inline sum accumulate( sum acc, vec a ) {
+			return _mm_add_pd(_mm_add_pd(acc,_mm_cvtps_pd(a)),_mm_cvtps_pd(_mm_movehl_ps(a,a)));
+		}
+		static inline sum zero() { return _mm_setzero_pd(); }
+		static inline double total( sum acc ) { return _mm_cvtsd_f64(acc)+_mm_cvtsd_f64(_mm_unpackhi_pd(acc,acc)); }
+	};
+#include "simdrows.h"
+	}
+#ifndef USE_FLOAT
+	namespace d {
+	typedef double real;
+	struct V {
+		typedef __m128d vec;
+		typedef __m128d mask;
+		enum { W = 2 };
+		static inline vec load( const real *p ) { return _mm_loadu_pd(p); }
+		static inline void store( real *p, vec a ) { _mm_storeu_pd(p,a); }
+		static inline vec set1( real a ) { return _mm_set1_pd(a); }
+		static inline vec add( vec a, vec b ) { return _mm_add_pd(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm_sub_pd(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm_mul_pd(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm_div_pd(a,b); }
+		static inline mask alternate( int first ) {
+			return _mm_castsi128_pd(first ? _mm_set_epi32(-1,-1,0,0) : _mm_set_epi32(0,0,-1,-1));
+		}
+		static inline vec left( vec a, vec b ) { return _mm_shuffle_pd(a,b,1); }
+		// No Masked Store Before AVX: The Other Lanes Get Back What Was Loaded
+		static inline void storeSome( real *p, mask m, vec a, vec old ) {
+			_mm_storeu_pd(p,_mm_or_pd(_mm_and_pd(m,a),_mm_andnot_pd(m,old)));
+		}
+		typedef __m128d sum;
+		static inline sum accumulate( sum acc, vec a ) { return _mm_add_pd(acc,a); }
+		static inline sum zero() { return _mm_setzero_pd(); }
+		static inline double total( sum acc ) { return _mm_cvtsd_f64(acc)+_mm_cvtsd_f64(_mm_unpackhi_pd(acc,acc)); }
+	};
+#include "simdrows.h"
+	}
+#endif
+}
+SIMD_TARGET_END
+
+SIMD_TARGET_BEGIN("avx2")
+namespace avx2 {
+	namespace f {
+	typedef float real;
+	struct V {
+		typedef __m256 vec;
+		enum { W = 8 };
+		static inline vec load( const real *p ) { return _mm256_loadu_ps(p); }
+		static inline void store( real *p, vec a ) { _mm256_storeu_ps(p,a); }
+		static inline vec set1( real a ) { return _mm256_set1_ps(a); }
+		static inline vec add( vec a, vec b ) { return _mm256_add_ps(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm256_sub_ps(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm256_mul_ps(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm256_div_ps(a,b); }
+		typedef __m256i mask;
+		static inline mask alternate( int first ) {
+			return first ? _mm256_set_epi32(-1,0,-1,0,-1,0,-1,0) : _mm256_set_epi32(0,-1,0,-1,0,-1,0,-1);
+		}
+		static inline vec left( vec a, vec b ) {
+			__m256i t = _mm256_permute2x128_si256(_mm256_castps_si256(a),_mm256_castps_si256(b),0x21);
+			return _mm256_castsi256_ps(_mm256_alignr_epi8(_mm256_castps_si256(b),t,12));
+		}
+		static inline void storeSome( real *p, mask m, vec a, vec ) { _mm256_maskstore_ps(p,m,a); }
+		static inline __m256d accumulate( __m256d acc, vec a ) {
+			acc = _mm256_add_pd(acc,_mm256_cvtps_pd(_mm256_castps256_ps128(a)));
+			return _mm256_add_pd(acc,_mm256_cvtps_pd(_mm256_extractf128_ps(a,1)));
+		}
+		typedef __m256d sum;
+		static inline sum zero() { return _mm256_setzero_pd(); }
+		static inline double total( sum acc ) {
+			__m128d s = _mm_add_pd(_mm256_castpd256_pd128(acc),_mm256_extractf128_pd(acc,1));
+			return _mm_cvtsd_f64(s)+_mm_cvtsd_f64(_mm_unpackhi_pd(s,s));
+		}
+	};
+#include "simdrows.h"
+	}
+#ifndef USE_FLOAT
+	namespace d {
+	typedef double real;
+	struct V {
+		typedef __m256d vec;
+		enum { W = 4 };
+		static inline vec load( const real *p ) { return _mm256_loadu_pd(p); }
+		static inline void store( real *p, vec a ) { _mm256_storeu_pd(p,a); }
+		static inline vec set1( real a ) { return _mm256_set1_pd(a); }
+		static inline vec add( vec a, vec b ) { return _mm256_add_pd(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm256_sub_pd(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm256_mul_pd(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm256_div_pd(a,b); }
+		typedef __m256i mask;
+		static inline mask alternate( int first ) {
+			return first ? _mm256_set_epi64x(-1,0,-1,0) : _mm256_set_epi64x(0,-1,0,-1);
+		}
+		static inline vec left( vec a, vec b ) {
+			__m256i t = _mm256_permute2x128_si256(_mm256_castpd_si256(a),_mm256_castpd_si256(b),0x21);
+			return _mm256_castsi256_pd(_mm256_alignr_epi8(_mm256_castpd_si256(b),t,8));
+		}
+		static inline void storeSome( real *p, mask m, vec a, vec ) { _mm256_maskstore_pd(p,m,a); }
+		static inline __m256d accumulate( __m256d acc, vec a ) { return _mm256_add_pd(acc,a); }
+		typedef __m256d sum;
+		static inline sum zero() { return _mm256_setzero_pd(); }
+		static inline double total( sum acc ) {
+			__m128d s = _mm_add_pd(_mm256_castpd256_pd128(acc),_mm256_extractf128_pd(acc,1));
+			return _mm_cvtsd_f64(s)+_mm_cvtsd_f64(_mm_unpackhi_pd(s,s));
+		}
+	};
+#include "simdrows.h"
+	}
+#endif
+}
+SIMD_TARGET_END
+
+// Some Plain AVX-512 Intrinsics Start From an Undefined Vector GCC 12 Warns About, The maskz Forms Don't
+SIMD_TARGET_BEGIN("avx512f")
+namespace avx512 {
+	namespace f {
+	typedef float real;
+	struct V {
+		typedef __m512 vec;
+		typedef __mmask16 mask;
+		enum { W = 16 };
+		static inline vec load( const real *p ) { return _mm512_loadu_ps(p); }
+		static inline void store( real *p, vec a ) { _mm512_storeu_ps(p,a); }
+		static inline vec set1( real a ) { return _mm512_set1_ps(a); }
+		static inline vec add( vec a, vec b ) { return _mm512_add_ps(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm512_sub_ps(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm512_mul_ps(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm512_div_ps(a,b); }
+		static inline mask alternate( int first ) { return first ? 0xAAAA : 0x5555; }
+		static inline vec left( vec a, vec b ) {
+			return _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFFFF,_mm512_castps_si512(b),_mm512_castps_si512(a),15));
+		}
+		static inline void storeSome( real *p, mask m, vec a, vec ) { _mm512_mask_storeu_ps(p,m,a); }
+		static inline __m512d accumulate( __m512d acc, vec a ) {
+			__m256 lo = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF,_mm512_castps_pd(a),0));
+			__m256 hi = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF,_mm512_castps_pd(a),1));
+			acc = _mm512_add_pd(acc,_mm512_maskz_cvtps_pd(0xFF,lo));
+			return _mm512_add_pd(acc,_mm512_maskz_cvtps_pd(0xFF,hi));
+		}
+		typedef __m512d sum;
+		static inline sum zero() { return _mm512_setzero_pd(); }
+		static inline double total( sum acc ) {
+			double lane[8];
+			_mm512_storeu_pd(lane,acc);
+			return ((lane[0]+lane[1])+(lane[2]+lane[3]))+((lane[4]+lane[5])+(lane[6]+lane[7]));
+		}
+	};
+#include "simdrows.h"
+	}
+#ifndef USE_FLOAT
+	namespace d {
+	typedef double real;
+	struct V {
+		typedef __m512d vec;
+		typedef __mmask8 mask;
+		enum { W = 8 };
+		static inline vec load( const real *p ) { return _mm512_loadu_pd(p); }
+		static inline void store( real *p, vec a ) { _mm512_storeu_pd(p,a); }
+		static inline vec set1( real a ) { return _mm512_set1_pd(a); }
+		static inline vec add( vec a, vec b ) { return _mm512_add_pd(a,b); }
+		static inline vec sub( vec a, vec b ) { return _mm512_sub_pd(a,b); }
+		static inline vec mul( vec a, vec b ) { return _mm512_mul_pd(a,b); }
+		static inline vec div( vec a, vec b ) { return _mm512_div_pd(a,b); }
+		static inline mask alternate( int first ) { return first ? 0xAA : 0x55; }
+		static inline vec left( vec a, vec b ) {
+			return _mm512_castsi512_pd(_mm512_maskz_alignr_epi64(0xFF,_mm512_castpd_si512(b),_mm512_castpd_si512(a),7));
+		}
+		static inline void storeSome( real *p, mask m, vec a, vec ) { _mm512_mask_storeu_pd(p,m,a); }
+		static inline __m512d accumulate( __m512d acc, vec a ) { return _mm512_add_pd(acc,a); }
+		typedef __m512d sum;
+		static inline sum zero() { return _mm512_setzero_pd(); }
+		static inline double total( sum acc ) {
+			double lane[8];
+			_mm512_storeu_pd(lane,acc);
+			return ((lane[0]+lane[1])+(lane[2]+lane[3]))+((lane[4]+lane[5])+(lane[6]+lane[7]));
+		}
+	};
+#include "simdrows.h"
+	}
+#endif
+}
+SIMD_TARGET_END
+#endif
+
+// The Namespace of real In Each Instruction Set
+#ifdef USE_FLOAT
+#define SIMD_REAL		f
+#else
+#define SIMD_REAL		d
+#endif
+
+static int simd_level = SIMD_SCALAR;
+simd::Kernels simd::kernels = scalar::kernels;
+#ifndef USE_FLOAT
+simd::KernelsT<float> simd::kernels_f = scalar::kernels_f;
+#endif
+
+static const simd::Kernels * table( int level ) {
+	switch( level ) {
+#ifdef SIMD_X86
+		case SIMD_SSE2:
+			return &sse2::SIMD_REAL::kernels;
+		case SIMD_AVX2:
+			return &avx2::SIMD_REAL::kernels;
+		case SIMD_AVX512:
+			return &avx512::SIMD_REAL::kernels;
+#endif
+		default:
+			return &scalar::kernels;
+	}
+}
+
+#ifndef USE_FLOAT
+// The Same Level For float Rows
+static const simd::KernelsT<float> * tableFloat( int level ) {
+	switch( level ) {
+#ifdef SIMD_X86
+		case SIMD_SSE2:
+			return &sse2::f::kernels;
+		case SIMD_AVX2:
+			return &avx2::f::kernels;
+		case SIMD_AVX512:
+			return &avx512::f::kernels;
+#endif
+		default:
+			return &scalar::kernels_f;
+	}
+}
+#endif
+
+bool simd::supported( int level ) {
+	if( level == SIMD_SCALAR ) return true;
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	switch( level ) {
+		case SIMD_SSE2:
+			return __builtin_cpu_supports("sse2");
+		case SIMD_AVX2:
+			return __builtin_cpu_supports("avx2");
+		case SIMD_AVX512:
+			return __builtin_cpu_supports("avx512f");
+	}
+#endif
+	return false;
+}
+
+// Largest |a-b| Relative To The Largest |b|
+static double difference( const real *a, const real *b, int n ) {
+	double diff = 0.0;
+	double scale = 1e-30;
+	for( int j=0; j<n; j++ ) {
+		diff = max(diff,fabs((double)a[j]-b[j]));
+		scale = max(scale,fabs((double)b[j]));
+	}
+	return diff/scale;
+}
+
+double simd::selfTest( int level ) {
+	if( ! supported(level) ) return -1.0;
+	const Kernels &k = *table(level);
+	const Kernels &s = scalar::kernels;
+	const int n = SIMD_TEST_N;
+
+	// Rows With One Halo Cell On Each Side, Filled From a Fixed Seed
+	real buf[8][SIMD_TEST_N+2];
+	unsigned int seed = 12345;
+	for( int r=0; r<8; r++ ) for( int j=0; j<n+2; j++ ) {
+		seed = seed*1664525+1013904223;
+		buf[r][j] = (seed>>8)/(double)(1<<24)*2.0-1.0;
+	}
+	const real *xm = buf[0]+1;
+	const real *x0 = buf[1]+1;
+	const real *xp = buf[2]+1;
+	const real *b = buf[3]+1;
+	real *want = buf[4]+1;
+	real *got = buf[5]+1;
+	real h = 1.0/n;
+	double worst = 0.0;
+
+	s.laplacian(want,xm,x0,xp,h*h,n);
+	k.laplacian(got,xm,x0,xp,h*h,n);
+	worst = max(worst,difference(got,want,n));
+
+	s.residual(want,b,xm,x0,xp,h*h,n);
+	k.residual(got,b,xm,x0,xp,h*h,n);
+	worst = max(worst,difference(got,want,n));
+
+	// Both Colors, Starting On And Off The Color, Ending Short of The Row
+	for( int parity=0; parity<2; parity++ ) for( int from=0; from<2; from++ ) {
+		memcpy(want-1,x0-1,sizeof(real)*(n+2));
+		memcpy(got-1,x0-1,sizeof(real)*(n+2));
+		s.relax(want,xm,xp,b,h*h,from,n-from,parity);
+		k.relax(got,xm,xp,b,h*h,from,n-from,parity);
+		worst = max(worst,difference(got-1,want-1,n+2));
+	}
+
+	double dw = s.dot(x0,b,n);
+	double dg = k.dot(x0,b,n);
+	double dscale = 1e-30;
+	for( int j=0; j<n; j++ ) dscale += fabs((double)x0[j]*b[j]);
+	worst = max(worst,fabs(dg-dw)/dscale);
+
+	// In Place, As The Solvers Call It
+	memcpy(want,b,sizeof(real)*n);
+	memcpy(got,b,sizeof(real)*n);
+	s.axpy(want,x0,want,-0.5,n);
+	k.axpy(got,x0,got,-0.5,n);
+	worst = max(worst,difference(got,want,n));
+
+	s.combine(want,x0,xp,0.75,-1.5,n);
+	k.combine(got,x0,xp,0.75,-1.5,n);
+	worst = max(worst,difference(got,want,n));
+
+	s.divergence(want,xm,xp,x0,h,n);
+	k.divergence(got,xm,xp,x0,h,n);
+	worst = max(worst,difference(got,want,n));
+
+	memcpy(want,b,sizeof(real)*n);
+	memcpy(got,b,sizeof(real)*n);
+	s.gradient(want,xm,x0,h,n);
+	k.gradient(got,xm,x0,h,n);
+	worst = max(worst,difference(got,want,n));
+	return worst;
+}
+
+int simd::init( int limit ) {
+	int best = SIMD_SCALAR;
+	for( int level=SIMD_LEVELS-1; level>SIMD_SCALAR; level-- ) {
+		if( limit >= 0 && level > limit ) continue;
+		double diff = selfTest(level);
+		if( diff < 0.0 ) continue;
+		if( diff > SIMD_TOLERANCE ) {
+			printf( "%s self-test failed ( Difference %.2e ), skipping it\n", simd_name[level], diff );
+			continue;
+		}
+		best = level;
+		break;
+	}
+	simd_level = best;
+	kernels = *table(best);
+#ifndef USE_FLOAT
+	kernels_f = *tableFloat(best);
+#endif
+	return best;
+}
+
+int simd::level() {
+	return simd_level;
+}
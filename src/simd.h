@@ -0,0 +1,76 @@
+/*
+ *  simd.h
+ *  smoke
+ *
+ */
+
+// Row Kernels Vectorized By Hand For SSE2, AVX2 And AVX-512, All In One Binary
+// init Picks The Widest Set CPUID Reports That Also Passes The Self-Test, So No -march Flag Is Needed
+// Other CPUs And Compilers Run The Scalar Loops
+
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#include "utility.h"
+
+#define SIMD_SCALAR		0
+#define SIMD_SSE2		1
+#define SIMD_AVX2		2
+#define SIMD_AVX512		3
+#define SIMD_LEVELS		4
+
+extern const char *simd_name[];
+
+namespace simd {
+	// One Row of Each Kernel In Precision T ( x0[-1] And x0[n] Are Halo Cells )
+	template <class T> struct KernelsT {
+		// a = ( xp + xm + x0[j+1] + x0[j-1] - 4 x0 ) / h2
+		void (*laplacian)( T *a, const T *xm, const T *x0, const T *xp, T h2, int n );
+
+		// r = b - ( xp + xm + x0[j+1] + x0[j-1] - 4 x0 ) / h2
+		void (*residual)( T *r, const T *b, const T *xm, const T *x0, const T *xp, T h2, int n );
+
+		// x0 = ( xp + xm + x0[j+1] + x0[j-1] - h2 b ) / 4 For The j In [from,to) With j&1 == parity
+		void (*relax)( T *x0, const T *xm, const T *xp, const T *b, T h2, int from, int to, int parity );
+
+		// RETURN: x^T y ( Summed In double )
+		double (*dot)( const T *x, const T *y, int n );
+
+		// ans = x + a y ( ans May Alias x or y )
+		void (*axpy)( T *ans, const T *x, const T *y, T a, int n );
+
+		// dst = a x + b y ( dst May Alias x or y )
+		void (*combine)( T *dst, const T *x, const T *y, T a, T b, int n );
+
+		// d = ( ( ux1 - ux0 ) + ( uy[j+1] - uy[j] ) ) / h
+		void (*divergence)( T *d, const T *ux0, const T *ux1, const T *uy, T h, int n );
+
+		// u = u - ( p1 - p0 ) / h ( u May Not Alias p0 or p1 )
+		void (*gradient)( T *u, const T *p0, const T *p1, T h, int n );
+	};
+	typedef KernelsT<real> Kernels;
+
+	// The Path In Use ( Scalar Until init )
+	extern Kernels kernels;
+
+#ifndef USE_FLOAT
+	// The Same Path For float Rows ( The Mixed Precision Correction Cycles )
+	extern KernelsT<float> kernels_f;
+#endif
+
+	// Switch To The Widest Path That Is Supported And Passes selfTest, At Most limit ( -1: No Limit )
+	// RETURN: The Level In Use
+	int init( int limit=-1 );
+
+	// The Level In Use
+	int level();
+
+	// Built Into This Binary And Reported By CPUID
+	bool supported( int level );
+
+	// Run Every Kernel of a Level On Random Rows Against The Scalar Path
+	// RETURN: Largest Relative Difference ( Negative When The Level Is Not Supported )
+	double selfTest( int level );
+}
+
+#endif
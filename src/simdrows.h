@@ -0,0 +1,106 @@
+/*
+ *  simdrows.h
+ *  smoke
+ *
+ */
+
+// Row Kernels Written Once Against The Vector Traits V ( See simd.cpp )
+// simd.cpp Includes This Once Per Instruction Set And Precision, Inside That Set's Target Region And Namespace,
+// So Every Copy Is Compiled For Its Own Set. The Scalar Tails Repeat The Reference Loops
+
+typedef V::vec vec;
+
+static void laplacian( real *a, const real *xm, const real *x0, const real *xp, real h2, int n ) {
+	vec h = V::set1(h2);
+	vec four = V::set1(4);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) {
+		vec s = V::add(V::add(V::add(V::load(xp+j),V::load(xm+j)),V::load(x0+j+1)),V::load(x0+j-1));
+		V::store( a+j, V::div(V::sub(s,V::mul(four,V::load(x0+j))),h) );
+	}
+	for( ; j<n; j++ ) a[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+}
+
+static void residual( real *r, const real *b, const real *xm, const real *x0, const real *xp, real h2, int n ) {
+	vec h = V::set1(h2);
+	vec four = V::set1(4);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) {
+		vec s = V::add(V::add(V::add(V::load(xp+j),V::load(xm+j)),V::load(x0+j+1)),V::load(x0+j-1));
+		V::store( r+j, V::sub(V::load(b+j),V::div(V::sub(s,V::mul(four,V::load(x0+j))),h)) );
+	}
+	for( ; j<n; j++ ) r[j] = b[j]-(xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+}
+
+// Every Lane Is Computed, Only Those of The Color Are Stored. Their Neighbors Are of The Other
+// Color, Which This Pass Never Changes, So The Left One Comes From The Vector Loaded Last Time
+// ( Loading x0+j-1 Would Straddle The Store Just Made And Stall Store Forwarding )
+static void relax( real *x0, const real *xm, const real *xp, const real *b, real h2, int from, int to, int parity ) {
+	vec h = V::set1(h2);
+	vec quarter = V::set1(0.25);
+	V::mask m = V::alternate((from^parity)&1);
+	int j = from;
+	if( j+V::W <= to ) {
+		vec x = V::load(x0+j);
+		vec left = V::load(x0+j-1);
+		for(;;) {
+			vec s = V::add(V::add(V::add(V::load(xp+j),V::load(xm+j)),V::load(x0+j+1)),left);
+			V::storeSome( x0+j, m, V::mul(V::sub(s,V::mul(h,V::load(b+j))),quarter), x );
+			j += V::W;
+			if( j+V::W > to ) break;
+			vec next = V::load(x0+j);
+			left = V::left(x,next);
+			x = next;
+		}
+	}
+	for( j+=(j^parity)&1; j<to; j+=2 ) {
+		x0[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-h2*b[j]) / 4;
+	}
+}
+
+static double dot( const real *x, const real *y, int n ) {
+	V::sum acc = V::zero();
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) acc = V::accumulate(acc,V::mul(V::load(x+j),V::load(y+j)));
+	double ans = V::total(acc);
+	for( ; j<n; j++ ) ans += x[j]*y[j];
+	return ans;
+}
+
+static void axpy( real *ans, const real *x, const real *y, real a, int n ) {
+	vec va = V::set1(a);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) V::store( ans+j, V::add(V::load(x+j),V::mul(va,V::load(y+j))) );
+	for( ; j<n; j++ ) ans[j] = x[j]+a*y[j];
+}
+
+static void combine( real *dst, const real *x, const real *y, real a, real b, int n ) {
+	vec va = V::set1(a);
+	vec vb = V::set1(b);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) V::store( dst+j, V::add(V::mul(va,V::load(x+j)),V::mul(vb,V::load(y+j))) );
+	for( ; j<n; j++ ) dst[j] = a*x[j]+b*y[j];
+}
+
+static void divergence( real *d, const real *ux0, const real *ux1, const real *uy, real h, int n ) {
+	vec vh = V::set1(h);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) {
+		vec dx = V::sub(V::load(ux1+j),V::load(ux0+j));
+		vec dy = V::sub(V::load(uy+j+1),V::load(uy+j));
+		V::store( d+j, V::div(V::add(dx,dy),vh) );
+	}
+	for( ; j<n; j++ ) d[j] = ((ux1[j]-ux0[j]) + (uy[j+1]-uy[j]))/h;
+}
+
+static void gradient( real *u, const real *p0, const real *p1, real h, int n ) {
+	vec vh = V::set1(h);
+	int j = 0;
+	for( ; j+V::W<=n; j+=V::W ) {
+		V::store( u+j, V::sub(V::load(u+j),V::div(V::sub(V::load(p1+j),V::load(p0+j)),vh)) );
+	}
+	for( ; j<n; j++ ) u[j] -= (p1[j]-p0[j])/h;
+}
+
+// 128-Bit Vectors Hold Only One Or Two Cells of The Color, The Scalar Loop Is Faster There
+static const simd::KernelsT<real> kernels = { laplacian, residual, sizeof(vec) > 16 ? relax : scalar::relax<real>, dot, axpy, combine, divergence, gradient };
@@ -8,6 +8,7 @@
 #include "solver.h"
 #include "utility.h"
 #include "advect.h"
+#include "simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -30,42 +31,147 @@ int	M;		// Smoke Grid Size
 
 #define		DT		0.1			// Watch for a CFL Limit in case of Derivative Advection
 
-#define NUM_ITER	500
+#define NUM_ITER	500			// Most Iterations Per Pressure Solve
+#define SOLVER_TOL	1.0e-5		// Relative Residual Each Pressure Solve Aims For
+#define DYE_UNPACK_REPEAT	10		// Widening Passes Timed By The Benchmark ( DYE_FIXED16 )
 
 static int solver_num = 2;
 static int advection_num = 3;
 static int interp_num = 0;
 static int integrator_num = 0;
-
-static double ***u = NULL;		// Access Bracket u[DIM][X][Y] ( Staggered Grid )
-static double **c = NULL;		// Equivalent to c[N][N]
-static double **p = NULL;		// Equivalent to p[N][N]
-static double **d = NULL;		// Equivalent to d[N][N]
-static double **vort = NULL;	// Equivalent to vort[N][N]
-
+static int cycle_num = CYCLE_V;
+static int smoother_num = SMOOTH_RBGS;
+static int layout_num = LAYOUT_ROW_MAJOR;
+static int dye_num = DYE_REAL;
+static int warm_num = WARM_ZERO;
+static bool log_frames = false;
+
+static const char *warm_name[] = { "Zero", "Previous", "Extrapolated", NULL };
+
+static MACGrid u;		// Access Bracket u[DIM][X][Y] ( Staggered Grid )
+static Grid2D c;		// Equivalent to c[N][N]
+static Grid2D16 c16;		// Same As c With DYE_FIXED16
+static Grid2D cShow;		// c16 Unpacked Once Per Frame For Display ( DYE_FIXED16 )
+static Grid2D p;		// Equivalent to p[N][N]
+static Grid2D pPrev;		// Pressure One Frame Before p ( WARM_EXTRAPOLATE )
+static Grid2D d;		// Equivalent to d[N][N]
+static Grid2D vort;		// Equivalent to vort[N][N]
+static Grid2D vcAdd[2];		// Vorticity Confinement Force
+
+static Workspace workspace;	// Scratch Memory of Every Module But The Solver
+static solver::Plan *plan = NULL;	// Pressure Solver of The Current Settings ( Rebuilt When They Change )
+static int plan_num = -1;
+static int plan_n = 0;
+static int plan_cycle = -1;
+static int plan_smoother = -1;
+
+static solver::Tolerance tolerance = { SOLVER_TOL, 0.0, NUM_ITER, 0.0 };
 static double residual = 0.0;
+static int iterations = 0;
 static unsigned long solverTime = 0;
 static unsigned long advectTime = 0;
 static unsigned long simTime = 0;
+static int frame = 0;
+
+// Per-Stage Timing
+enum { STAGE_BOUNDARY, STAGE_DIVERGENCE, STAGE_PRESSURE, STAGE_SUBTRACT, STAGE_ADVECTION, NUM_STAGE };
+static const char *stage_name[] = { "Boundary", "Divergence", "Pressure", "Subtract", "Advection" };
+static unsigned long stageTime[NUM_STAGE];
 
 static bool show_velocity = true;
 static bool show_pressure = true;
 static bool dragging = false;
 
+// Dye As real: c Itself, Or c16 Unpacked Into cShow In One Pass
+// So Readers Don't Branch On The Storage Per Cell
+static Grid2D dyeView() {
+	if( dye_num == DYE_REAL ) return c;
+	if( ! cShow.ptr ) cShow = alloc2D(M);
+	unpack16(cShow,c16,M,M);
+	return cShow;
+}
+
+// Fill The Disk of Radius w Around (i,j) With v
+template <class T> static void stampDye( Grid2DT<T> dye, int i, int j, int w, T v ) {
+	for( int ii = -w; ii <= w; ii++ ) {
+		for( int jj = -w; jj <= w; jj++ ) {
+			if( hypot(ii,jj) <= w ) dye[i+ii][j+jj] = v;
+		}
+	}
+}
+
+static void bindScratch( Workspace &ws ) {
+	advect::bind(ws,N,M);
+	vcAdd[0] = carve2D(ws,N);
+	vcAdd[1] = carve2D(ws,N);
+}
+
+// Build The Pressure Solver of The Current Settings, Dropping The Last One
+static void planSolver() {
+	if( plan_num == solver_num && plan_n == N && plan_cycle == cycle_num && plan_smoother == smoother_num ) return;
+	solver::destroyPlan(plan);
+	plan = solver::createPlan(solver_num,N,tolerance,cycle_num,smoother_num);
+	plan_num = solver_num;
+	plan_n = N;
+	plan_cycle = cycle_num;
+	plan_smoother = smoother_num;
+	printf( "Solver Plan: %.2f MB ( %s )\n", solver::footprint(plan)/(1024.0*1024.0), solver_name[solver_num] );
+}
+
+void smoke2D::setLayout( int layout ) {
+	layout_num = layout;
+	advect::setLayout(layout);
+}
+
+void smoke2D::setDyeStorage( int storage ) {
+	dye_num = storage;
+	advect::setDyeStorage(storage);
+}
+
+void smoke2D::setWarmStart( int mode ) {
+	warm_num = mode;
+}
+
+void smoke2D::setSmoother( int type ) {
+	smoother_num = type;
+}
+
+void smoke2D::setTolerance( double relative ) {
+	tolerance.relative = relative;
+	if( plan ) solver::setTolerance(plan,tolerance);
+}
+
+void smoke2D::setTimeBudget( double maxTime ) {
+	tolerance.maxTime = maxTime;
+	if( plan ) solver::setTolerance(plan,tolerance);
+}
+
+void smoke2D::setLogging( bool log ) {
+	log_frames = log;
+}
+
 void smoke2D::init( int gsize ) {
 	N = gsize;
 	M = gsize*2;
+	
+	// Allocate Scratch Memory Once
+	if( ! workspace.slab ) {
+		allocWorkspace(workspace,bindScratch);
+		printf( "Workspace: %.2f MB\n", workspace.capacity/(1024.0*1024.0) );
+	}
+	planSolver();
 		
 	// Allocate Variables
-	if( ! p ) p = alloc2D(N);	
-	if( ! d ) d = alloc2D(N);
-	if( ! c ) c = alloc2D(M);
-	if( ! vort ) vort = alloc2D(N);
-	if( ! u ) {
-		u = new double **[3];
-		u[0] = alloc2D(N+1);
-		u[1] = alloc2D(N+1);
+	if( ! p.ptr ) p = alloc2D(N,SOLVER_HALO);	
+	if( ! pPrev.ptr ) pPrev = alloc2D(N);
+	if( ! d.ptr ) d = alloc2D(N);
+	if( dye_num == DYE_FIXED16 ) {
+		if( ! c16.ptr ) c16 = alloc2DT<fixed16>(M,M,ADVECT_HALO);
+	} else {
+		if( ! c.ptr ) c = alloc2D(M,ADVECT_HALO);
 	}
+	if( ! vort.ptr ) vort = alloc2D(N);
+	if( ! u[0].ptr ) u = allocMAC(N,ADVECT_HALO);
 	
 	// Clear Variables
 	FOR_EVERY_X_FLOW(N) {
@@ -76,13 +182,22 @@ void smoke2D::init( int gsize ) {
 		u[1][i][j] = 0.0;
 	} END_FOR
 	
-	FOR_EVERY_CELL(M) {
-		c[i][j] = 0.0;
-	} END_FOR
+	if( dye_num == DYE_FIXED16 ) {
+		FOR_EVERY_CELL(M) {
+			c16[i][j] = 0;
+		} END_FOR
+	} else {
+		FOR_EVERY_CELL(M) {
+			c[i][j] = 0.0;
+		} END_FOR
+	}
 	
-	// Turn On Blending
-	glEnable(GL_BLEND);
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	// No History To Start From
+	FOR_EVERY_CELL(N) {
+		p[i][j] = 0.0;
+		pPrev[i][j] = 0.0;
+	} END_FOR
+	frame = 0;
 }
 
 void smoke2D::reshape( int w, int h ) {
@@ -92,20 +207,6 @@ void smoke2D::reshape( int w, int h ) {
 	glOrtho(-margin,1.0+margin,-margin,1.0+margin,-1.0,1.0);
 }
 
-static unsigned long getMicroseconds()
-{
-#if defined(_WIN32)
-	LARGE_INTEGER nFreq, Time;
-	QueryPerformanceFrequency(&nFreq);
-	QueryPerformanceCounter(&Time);
-	return (double)Time.QuadPart / nFreq.QuadPart * 1000000;
-#else
-	struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec*1000000 + tv.tv_usec;
-#endif
-}
-
 static unsigned long tickTime() {
 	static unsigned long prevTime = getMicroseconds();
 	unsigned long curTime = getMicroseconds();
@@ -127,11 +228,8 @@ static void drawBitmapString( const char *string )
 }
 
 static void comp_divergence() {
-	double h = 1.0/N;
-	FOR_EVERY_CELL(N) {
-		double div = (u[0][i+1][j]-u[0][i][j]) + (u[1][i][j+1]-u[1][i][j]);
-		d[i][j] = div/h;
-	} END_FOR
+	real h = 1.0/N;
+	for( int i=0; i<N; i++ ) simd::kernels.divergence( d[i], u[0][i], u[0][i+1], u[1][i], h, N );
 }
 
 static void enforce_boundary() {
@@ -145,38 +243,57 @@ static void enforce_boundary() {
 }
 
 static void compute_pressure() {
-	// Clear Pressure
-	FOR_EVERY_CELL(N) {
-		p[i][j] = 0.0;
-	} END_FOR
+	// Initial Guess
+	if( warm_num == WARM_ZERO ) {
+		FOR_EVERY_CELL(N) {
+			p[i][j] = 0.0;
+		} END_FOR
+	} else {
+		// Keep The History Either Way So Switching Modes Stays Smooth
+		bool extrapolate = warm_num == WARM_EXTRAPOLATE;
+		FOR_EVERY_CELL(N) {
+			real last = p[i][j];
+			if( extrapolate ) p[i][j] = 2*last-pPrev[i][j];
+			pPrev[i][j] = last;
+		} END_FOR
+	}
 	
+	planSolver();
 	tickTime();
 	// Solve Ap = d ( p = Pressure, d = Divergence )
-	residual = solver::solve( solver_num, NUM_ITER, p, d, N );
+	solver::Result result = solver::execute( plan, p, d );
 	solverTime = tickTime();
+	residual = result.residual;
+	iterations = result.iterations;
+	
+	if( log_frames ) {
+		printf( "Frame=%d Solver=%s WarmStart=%s Iterations=%d Residual=%.3e Time=%.3fms%s\n", frame, solver_name[solver_num],
+			   warm_name[warm_num], iterations, residual, result.time, result.converged ? "" : " ( Not Converged )" );
+		printf( "History=" );
+		for( int k=0; k<result.count; k++ ) printf( " %.2e", result.history[k] );
+		printf( "\n" );
+	}
+	frame ++;
 }
 
 static void subtract_pressure() {
-	double h = 1.0/N;
-	FOR_EVERY_X_FLOW(N) {
-		if( i>0 && i<N ) u[0][i][j] -= (p[i][j]-p[i-1][j])/h;
-	} END_FOR
+	real h = 1.0/N;
+	for( int i=1; i<N; i++ ) simd::kernels.gradient( u[0][i], p[i-1], p[i], h, N );
 	
-	FOR_EVERY_Y_FLOW(N) {
-		if( j>0 && j<N ) u[1][i][j] -= (p[i][j]-p[i][j-1])/h;
-	} END_FOR
+	// Interior Faces j = 1 To N-1
+	for( int i=0; i<N; i++ ) simd::kernels.gradient( u[1][i]+1, p[i], p[i]+1, h, N-1 );
 }
 
 static void advection() {
 	tickTime();
-	advect::advect(advection_num,interp_num,integrator_num,u,c,N,M,DT);
+	if( dye_num == DYE_FIXED16 ) advect::advect(advection_num,interp_num,integrator_num,u,c16,N,M,DT);
+	else advect::advect(advection_num,interp_num,integrator_num,u,c,N,M,DT);
 	advectTime = tickTime();
 }
 
 static void vorticityConfinement() {
-	double h = 1.0/N;
-	double e = 0.1;
-	static double ** vcAdd[2] = {alloc2D(N),alloc2D(N)};
+	real h = 1.0/N;
+	real e = 0.1;
 	
 	// Compute Vorticty
 	FOR_EVERY_CELL(N) {
@@ -185,15 +302,15 @@ static void vorticityConfinement() {
 	
 	FOR_EVERY_CELL(N) {
 		if( i==0 || i==N-1 || j==0 || j==N-1 ) continue;
-		double w = vort[i][j];
-		double n[2] = { (fabs(vort[i+1][j])-fabs(vort[i-1][j]))*0.5/h, (fabs(vort[i][j+1])-fabs(vort[i][j-1]))*0.5/h };
-		double len = hypot( n[0], n[1] );
+		real w = vort[i][j];
+		real n[2] = { (fabs(vort[i+1][j])-fabs(vort[i-1][j]))*0.5/h, (fabs(vort[i][j+1])-fabs(vort[i][j-1]))*0.5/h };
+		real len = hypot( n[0], n[1] );
 		vcAdd[0][i][j] = 0.0;
 		vcAdd[1][i][j] = 0.0;
 		if( len )
 		{
-			double NL[2] = { n[0]/len, n[1]/len };
-			double Nw[2] = { NL[1]*w, -NL[0]*w };
+			real NL[2] = { n[0]/len, n[1]/len };
+			real Nw[2] = { NL[1]*w, -NL[0]*w };
 			vcAdd[0][i][j] = DT*e*h*Nw[0];
 			vcAdd[1][i][j] = DT*e*h*Nw[1];
 		}
@@ -208,20 +325,102 @@ static void vorticityConfinement() {
 	} END_FOR
 }
 
+#define RUN_STAGE(stage,func)	{ unsigned long t = getMicroseconds(); func(); stageTime[stage] = getMicroseconds()-t; }
+
 static void computeStep() {
 	
 	unsigned long startTime = getMicroseconds();
 	
-	enforce_boundary();
-	comp_divergence();
-	compute_pressure();
-	subtract_pressure();
-	advection();
+	RUN_STAGE(STAGE_BOUNDARY,enforce_boundary);
+	RUN_STAGE(STAGE_DIVERGENCE,comp_divergence);
+	RUN_STAGE(STAGE_PRESSURE,compute_pressure);
+	RUN_STAGE(STAGE_SUBTRACT,subtract_pressure);
+	RUN_STAGE(STAGE_ADVECTION,advection);
 	//vorticityConfinement();
 	
 	simTime = getMicroseconds()-startTime;
 }
 
+void smoke2D::benchmark( int gsize, int steps, int solver, int advection ) {
+	if( solver >= 0 ) solver_num = solver;
+	if( advection >= 0 ) advection_num = advection;
+	init(gsize);
+	
+	double total[NUM_STAGE];
+	double totalSim = 0.0;
+	double totalSolver = 0.0;
+	int totalIterations = 0;
+	for( int s=0; s<NUM_STAGE; s++ ) total[s] = 0.0;
+	
+	for( int n=0; n<steps; n++ ) {
+		// Stir Around The Center Just Like a Dragging Mouse
+		double t = 2.0*3.14159265358979*n/(double)steps;
+		smoke2D::motion( 0.5+0.2*cos(t), 0.5+0.2*sin(t), -0.01*sin(t), 0.01*cos(t) );
+		computeStep();
+		for( int s=0; s<NUM_STAGE; s++ ) total[s] += stageTime[s];
+		totalSim += simTime;
+		totalSolver += solverTime;
+		totalIterations += iterations;
+	}
+	
+	printf( "Grid=%d Steps=%d Solver=%s Advection=%s Layout=%s Dye=%s WarmStart=%s Residual=%.2e\n", N, steps,
+		   solver_name[solver_num], advection_name[advection_num], layout_name[layout_num], dye_name[dye_num], warm_name[warm_num], residual );
+	for( int s=0; s<NUM_STAGE; s++ ) {
+		printf( "%-12s %10.3f ms\n", stage_name[s], total[s]/1000.0/steps );
+	}
+	printf( "%-12s %10.3f ms\n", "Total", totalSim/1000.0/steps );
+	printf( "SIMD=%s\n", simd_name[simd::level()] );
+	if( solver_num == 4 ) printf( "Cycle=%s\n", cycle_name[cycle_num] );
+	if( solver_num >= 2 && solver_num <= 5 ) printf( "Smoother=%s\n", smoother_name[smoother_num] );
+	printf( "Iterations/Frame=%.2f Tolerance=%.1e\n", totalIterations/(double)steps, tolerance.relative );
+	double fused = solver::bytesPerIteration(solver_num,N);
+	double unfused = solver::bytesPerIteration(solver_num,N,false);
+	const char *baseline = solver_num == 10 ? "Unblocked" : "Unfused";
+	if( fused != unfused ) {
+		printf( "Bytes/Iteration=%.0f ( %s %.0f, %.0f%% Less )\n", fused, baseline, unfused, 100.0*(1.0-fused/unfused) );
+	} else if( fused ) {
+		printf( "Bytes/Iteration=%.0f\n", fused );
+	}
+	
+	// Roofline Check: Bandwidth Near The Machine's Means The Solver Is Memory Bound,
+	// "As If" Above It Means Blocking Or Fusion Saved Trips To Memory
+	if( fused && totalSolver ) {
+		double seconds = totalSolver/1000000.0;
+		printf( "Bandwidth=%.2f GB/s", fused*totalIterations/seconds/1e9 );
+		if( fused != unfused ) printf( " ( As If %s %.2f GB/s )", baseline, unfused*totalIterations/seconds/1e9 );
+		printf( "\n" );
+	}
+	
+	// Dye Traffic: The Advection Reads And Writes The Dye Once Per Frame, Half Or a Quarter
+	// The Bytes With DYE_FIXED16, Which Only Pays a Widening Pass Per Frame For Display
+	double dyeBytes = 2.0*M*M*(dye_num == DYE_FIXED16 ? sizeof(fixed16) : sizeof(real));
+	double realBytes = 2.0*M*M*sizeof(real);
+	if( dye_num == DYE_FIXED16 ) {
+		dyeView();
+		unsigned long t = getMicroseconds();
+		for( int k=0; k<DYE_UNPACK_REPEAT; k++ ) dyeView();
+		unsigned long elapsed = getMicroseconds()-t;
+		double seconds = max(elapsed,1UL)/1000000.0;
+		printf( "Dye Bytes/Frame=%.0f ( real %.0f, %.0f%% Less ) Unpack=%.2f GB/s\n", dyeBytes, realBytes, 100.0*(1.0-dyeBytes/realBytes),
+			   DYE_UNPACK_REPEAT*M*M*(sizeof(fixed16)+sizeof(real))/seconds/1e9 );
+	} else {
+		printf( "Dye Bytes/Frame=%.0f\n", dyeBytes );
+	}
+	
+	// Field Summary To Compare Builds ( e.g. float Against double )
+	Grid2D dye = dyeView();
+	double dyeSum = 0.0;
+	double energy = 0.0;
+	FOR_EVERY_CELL(M) {
+		dyeSum += dye[i][j];
+	} END_FOR
+	FOR_EVERY_CELL(N) {
+		double v[2] = { u.centerX(i,j), u.centerY(i,j) };
+		energy += 0.5*(v[0]*v[0]+v[1]*v[1]);
+	} END_FOR
+	printf( "Precision=%s Dye=%.9e Energy=%.9e\n", sizeof(real) == sizeof(float) ? "float" : "double", dyeSum/(M*M), energy/(N*N) );
+}
+
 void smoke2D::display() {
 	
 	// Simulate One Step
@@ -229,6 +428,7 @@ void smoke2D::display() {
 	
 	// Draw Concentration
 #if 1
+	Grid2D dye = dyeView();
 	FOR_EVERY_CELL(M) {
 		if( i == M-1 || j == M-1 ) continue;
 		double h = 1.0/M;
@@ -236,13 +436,13 @@ void smoke2D::display() {
 		double color[3] = { 0.4, 0.6, 1.0 };
 		double ex = show_velocity && dragging ? 0.3 : 1.0;
 		glBegin(GL_QUADS);
-		glColor4d(color[0],color[1],color[2],c[i][j]*ex);
+		glColor4d(color[0],color[1],color[2],dye[i][j]*ex);
 		glVertex2d(p[0],p[1]);
-		glColor4d(color[0],color[1],color[2],c[i+1][j]*ex);
+		glColor4d(color[0],color[1],color[2],dye[i+1][j]*ex);
 		glVertex2d(p[0]+h,p[1]);
-		glColor4d(color[0],color[1],color[2],c[i+1][j+1]*ex);
+		glColor4d(color[0],color[1],color[2],dye[i+1][j+1]*ex);
 		glVertex2d(p[0]+h,p[1]+h);
-		glColor4d(color[0],color[1],color[2],c[i][j+1]*ex);
+		glColor4d(color[0],color[1],color[2],dye[i][j+1]*ex);
 		glVertex2d(p[0],p[1]+h);
 		glEnd();
 	} END_FOR
@@ -324,7 +524,7 @@ void smoke2D::display() {
 		FOR_EVERY_CELL(N) {
 			double h = 1.0/N;
 			double p[2] = {i*h+h/2.0,j*h+h/2.0};
-			double v[2] = {0.5*u[0][i][j]+0.5*u[0][i+1][j],0.5*u[1][i][j]+0.5*u[1][i][j+1]};
+			double v[2] = { u.centerX(i,j), u.centerY(i,j) };
 			double s = 10.0;
 			glBegin(GL_LINES);
 			glVertex2d(p[0],p[1]);
@@ -336,14 +536,17 @@ void smoke2D::display() {
 	// Display Method Text
 	glColor4f(1.0,1.0,1.0,1.0);
 	glRasterPos2d(0.04, 0.065);
-	char tmp[64];
+	char tmp[128];
 	cnt = 0; // Reset Message Counter
-	sprintf( tmp, "%s (Time=%.2fms, Residual=%.2e)", solver_name[solver_num], solverTime/(double)1000, residual );
+	if( solver_num == 4 )
+		sprintf( tmp, "%s (Time=%.2fms, Residual=%.2e, Iterations=%d, %s)", solver_name[solver_num], solverTime/(double)1000, residual, iterations, cycle_name[cycle_num] );
+	else
+		sprintf( tmp, "%s (Time=%.2fms, Residual=%.2e, Iterations=%d)", solver_name[solver_num], solverTime/(double)1000, residual, iterations );
 	drawBitmapString(tmp);
 	
 	glRasterPos2d(0.04, 0.03);
 	if( advection_num > 2 )
-		sprintf( tmp, "%s (Time=%.2fms, Interp=%s)", advection_name[advection_num], advectTime/(double)1000, interp_name[interp_num] );
+		sprintf( tmp, "%s (Time=%.2fms, Interp=%s, Layout=%s)", advection_name[advection_num], advectTime/(double)1000, interp_name[interp_num], layout_name[layout_num] );
 	else 
 		sprintf( tmp, "%s (Time=%.2fms, Integrator=%s)", advection_name[advection_num], advectTime/(double)1000, integrator_name[integrator_num] );
 	cnt = 0;
@@ -372,6 +575,15 @@ void smoke2D::display() {
 	raw_drawBitmapString("Press \"v\" to toggle velocity view");
 	
 	glRasterPos2d(0.04, 0.72);
+	raw_drawBitmapString("Press \"m\" to switch multigrid cycle");
+	
+	glRasterPos2d(0.04, 0.69);
+	raw_drawBitmapString("Press \"w\" to switch pressure warm start");
+	
+	glRasterPos2d(0.04, 0.66);
+	raw_drawBitmapString("Press \"j\" to switch multigrid smoother");
+	
+	glRasterPos2d(0.04, 0.63);
 	raw_drawBitmapString("Press \"c\" to clear all");
 }
 
@@ -402,6 +614,18 @@ void smoke2D::keyDown( unsigned char key ) {
 			integrator_num ++;
 			if( ! integrator_name[integrator_num] ) integrator_num = 0;
 			break;
+		case 'm':
+			cycle_num ++;
+			if( ! cycle_name[cycle_num] ) cycle_num = 0;
+			break;
+		case 'j':
+			smoother_num ++;
+			if( ! smoother_name[smoother_num] ) smoother_num = 0;
+			break;
+		case 'w':
+			warm_num ++;
+			if( ! warm_name[warm_num] ) warm_num = 0;
+			break;
 		case '\e':
 			exit(0);
 			break;
@@ -427,13 +651,8 @@ void smoke2D::motion( double x, double y, double dx, double dy ) {
 	j = min(M-1,max(0,y*M));
 	int w = M/N;
 	if( i>w && i<M-w-1 && j>w && j < M-w-1 ) {
-		for( int ii = -w; ii <= w; ii++ ) {
-			for( int jj = -w; jj <= w; jj++ ) {
-				if( hypot(ii,jj) <= w ) {
-					c[i+ii][j+jj] = 2.0;
-				}
-			}
-		}
+		if( dye_num == DYE_FIXED16 ) stampDye(c16,i,j,w,toFixed16(2.0));
+		else stampDye(c,i,j,w,(real)2.0);
 	}
 }
 
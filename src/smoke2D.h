@@ -4,6 +4,11 @@
  *
  */
 
+// Pressure Warm Start
+#define WARM_ZERO			0	// Start From Zero
+#define WARM_PREVIOUS		1	// Start From The Last Frame's Pressure
+#define WARM_EXTRAPOLATE	2	// Linear Extrapolation From The Last Two Frames
+
 namespace smoke2D {
 	void init( int gsize );
 	void reshape( int w, int h );
@@ -11,4 +16,28 @@ namespace smoke2D {
 	void mouse( double x, double y, int state );
 	void motion( double x, double y, double dx, double dy );
 	void keyDown( unsigned char key );
+	
+	// Storage Layout of The Back-Trace Sources ( 0: Row-Major, 1: Tiled ), Call Before init
+	void setLayout( int layout );
+	
+	// Dye Storage ( 0: real, 1: 16-bit Fixed Point ), Call Before init
+	void setDyeStorage( int storage );
+	
+	// Initial Guess of Each Pressure Solve ( WARM_ZERO, WARM_PREVIOUS Or WARM_EXTRAPOLATE )
+	void setWarmStart( int mode );
+	
+	// Multigrid Smoother ( SMOOTH_RBGS, SMOOTH_GS Or SMOOTH_CHEBYSHEV )
+	void setSmoother( int type );
+	
+	// Stop Each Pressure Solve At This Relative Residual
+	void setTolerance( double relative );
+	
+	// Or After This Many Milliseconds ( 0: No Limit )
+	void setTimeBudget( double maxTime );
+	
+	// Print Iterations And Residual History of Every Pressure Solve
+	void setLogging( bool log );
+	
+	// Run Headless And Print The Average Time of Each Stage
+	void benchmark( int gsize, int steps, int solver=-1, int advection=-1 );
 }
\ No newline at end of file
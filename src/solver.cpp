@@ -9,56 +9,346 @@
 #include <math.h>
 #include "solver.h"
 #include "utility.h"
+#include "simd.h"
 
-const char *solver_name[] = { "Gauss-Seidel", "Conjugate Gradient", "Multigrid", NULL };
+const char *solver_name[] = { "Gauss-Seidel", "Conjugate Gradient", "Multigrid", "Mixed Precision Multigrid", "Full Multigrid", "Multigrid Preconditioned CG", "MIC(0) Preconditioned CG", "DCT Direct Solver", "Pipelined CG", "Deflated CG", "Blocked Gauss-Seidel", NULL };
+const char *cycle_name[] = { "V-Cycle", "W-Cycle", "F-Cycle", NULL };
+const char *smoother_name[] = { "Red-Black Gauss-Seidel", "Gauss-Seidel", "Chebyshev-Jacobi", NULL };
+
+// Scratch Memory ( Carved From Its Plan's Workspace By bindPlan, Only What The Method Uses )
+// The Hierarchies Are Sized From The Grid, One Entry Per Level
+template <class T> struct Scratch {
+	Grid2DT<T> r;						// Residual
+	Grid2DT<T> p;						// Search Direction
+	Grid2DT<T> Ap;						// A * Search Direction
+	Grid2DT<T> z;						// Preconditioned Residual ( A s In Pipelined CG )
+	Grid2DT<T> w[2];					// A r, Double Buffered ( Pipelined CG )
+	Grid2DT<T> mic;						// MIC(0) Factor
+	Grid2DT<T> dct_work;				// One Complex Row of Length fftLength(n) Per Row ( DCT Solver )
+	Grid2DT<T> *fine_r;					// Multigrid Hierarchy ( One Level Per mgv Recursion )
+	Grid2DT<T> *fine_e;
+	Grid2DT<T> *coarse_r;
+	Grid2DT<T> *coarse_e;
+	Grid2DT<T> *level_x;				// Full Multigrid Hierarchy ( Level 0 Is The Finest )
+	Grid2DT<T> *level_b;
+	Grid2DT<T> *level_r;
+	int *level_n;
+	int levels;
+	int top_n;							// Finest Size ( Level 0 )
+	Grid2DT<T> *cheb_r;					// Chebyshev Smoother Residual And Step ( One Per mgv Level, Down To 1 x 1 )
+	Grid2DT<T> *cheb_d;
+	double *cheb_max;					// Largest Eigenvalue of D^-1 A Per Level, Times CHEB_SAFETY
+	Grid2DT<T> *rec_w;					// Recycled Basis W ( Deflated CG, rec_k Vectors Valid )
+	Grid2DT<T> *rec_aw;					// A W
+	Grid2DT<T> *rec_s;					// Snapshots of x Along The Current Solve
+	double *rec_sAs;					// Their s^T A s ( See harvestRecycle )
+	double *rec_L;						// Cholesky Factor of -W^T A W
+	int rec_k;
+	int rec_stride;						// Iterations Between Harvests ( The Last Solve Spread Over RECYCLE_M )
+};
+
+// Size of The Next Coarser Level
+// An Odd n Rounds Up, With The Coarse Cells Centered On The Even Fine Cells ( See restrictOdd )
+static int coarsen( int n ) {
+	return (n+1)/2;
+}
+
+// Full Multigrid Settings
+#define FMG_PRE			2		// Smoothing Sweeps Before Restriction
+#define FMG_POST		2		// Smoothing Sweeps After Prolongation
+#define COARSE_MIN		8		// Stop Coarsening At This Size ( Solved Exactly )
+#define COARSE_ODD		48		// Or At An Odd Size Up To This ( Odd Levels Coarsen Less Accurately )
+// Bookkeeping of a Solve
+#define MAX_HISTORY		1024
+
+// Everything One Method Needs At One Size, Carved From The Plan's Own Workspace
+// Plans Share No State, So Any Number of Sizes Can Be Solved In The Same Process, Even At Once
+struct solver::Plan {
+	int method;
+	int n;
+	int cycle;							// CYCLE_V, CYCLE_W Or CYCLE_F ( Full Multigrid )
+	int smoother;						// SMOOTH_RBGS, SMOOTH_GS Or SMOOTH_CHEBYSHEV
+	Tolerance tol;
+	Workspace ws;
+	Scratch<double> scratch_d;			// Scratch of Each Precision ( The Mixed Precision Solver Uses Both )
+	Scratch<float> scratch_f;
+	
+	// Cholesky Factor of The Coarsest Level ( Shared By Every Precision )
+	double *coarse_L;
+	double *coarse_y;
 	
-// Clamped Fetch
-static double x_ref( double **x, int i, int j, int n ) {
-	i = min(max(0,i),n-1);
-	j = min(max(0,j),n-1);
-	return x[i][j];
+	// Spectral Solver Tables ( Shared By Every Precision )
+	bool dct_fast;						// n Is a Power of Two ( FFT Based Transform )
+	double *dct_lambda;					// Eigenvalues of The 1D Unit Stencil, 2cos(pi k/n)-2
+	double *dct_shift;					// cos And sin of pi k/(2n), k < n
+	int fft_n;							// FFT Length, n Or The Bluestein Convolution Length
+	double *fft_twiddle;				// e^(-2 pi i k/fft_n), k < fft_n/2
+	double *chirp;						// e^(-pi i k^2/n), k < n ( Bluestein )
+	double *chirp_fft;					// FFT of The Conjugate Chirp, Wrapped To Length fft_n ( Bluestein )
+	
+	// Mixed Precision Refinement Buffers
+	Grid2DT<double> ref_x;
+	Grid2DT<double> ref_b;
+	Grid2DT<double> ref_r;
+	
+	// The Current Solve
+	Result stats;
+	double history[MAX_HISTORY];
+	double target;						// Residual To Reach
+	unsigned long start_time;
+};
+
+template <class T> static Scratch<T> &scratch( solver::Plan *plan );
+template <> inline Scratch<double> &scratch<double>( solver::Plan *plan ) {
+	return plan->scratch_d;
+}
+template <> inline Scratch<float> &scratch<float>( solver::Plan *plan ) {
+	return plan->scratch_f;
 }
 
-// Ans = Ax
-static void compute_Ax( double **x, double **ans, int n ) {
-	double h2 = 1.0/(n*n);
-	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) {
-		ans[i][j] = (x_ref(x,i+1,j,n)+x_ref(x,i-1,j,n)+x_ref(x,i,j+1,n)+x_ref(x,i,j-1,n)-4.0*x[i][j])/h2;
+// Spectral Solver Constant
+#define DCT_PI			3.14159265358979323846
+
+// Record The Residual After stats.iterations Iterations
+// RETURN: Whether To Stop
+static bool finished( solver::Plan *plan, double res ) {
+	solver::Result &stats = plan->stats;
+	if( stats.count < MAX_HISTORY ) plan->history[stats.count++] = res;
+	stats.residual = res;
+	if( res <= plan->target ) stats.converged = true;
+	return stats.converged || stats.iterations >= plan->tol.maxIter ||
+		( plan->tol.maxTime > 0 && (getMicroseconds()-plan->start_time)/1000.0 >= plan->tol.maxTime );
+}
+	
+// Row Kernels ( real Rows Take The simd Path Picked At Startup, Other Precisions Stay Scalar
+// Apart From The float Multigrid Rows of The double Build Below )
+template <class T> static inline void laplacianRow( T *a, const T *xm, const T *x0, const T *xp, T h2, int n ) {
+	for( int j=0; j<n; j++ ) a[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+}
+static inline void laplacianRow( real *a, const real *xm, const real *x0, const real *xp, real h2, int n ) {
+	simd::kernels.laplacian(a,xm,x0,xp,h2,n);
+}
+
+template <class T> static inline void residualRow( T *r, const T *b, const T *xm, const T *x0, const T *xp, T h2, int n ) {
+	for( int j=0; j<n; j++ ) r[j] = b[j]-(xp[j]+xm[j]+x0[j+1]+x0[j-1]-4*x0[j])/h2;
+}
+static inline void residualRow( real *r, const real *b, const real *xm, const real *x0, const real *xp, real h2, int n ) {
+	simd::kernels.residual(r,b,xm,x0,xp,h2,n);
+}
+
+// Updates The j In [from,to) With j&1 == parity
+template <class T> static inline void relaxRow( T *x0, const T *xm, const T *xp, const T *b, T h2, int from, int to, int parity ) {
+	for( int j=from+((from^parity)&1); j<to; j+=2 ) {
+		x0[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-h2*b[j]) / 4;
 	}
 }
+static inline void relaxRow( real *x0, const real *xm, const real *xp, const real *b, real h2, int from, int to, int parity ) {
+	simd::kernels.relax(x0,xm,xp,b,h2,from,to,parity);
+}
 
-// Gauss-Seidel Iteration
-static void gaussseidel( double **x, double **b, int n, int t ) {
-	double h2 = 1.0/(n*n);
-	for( int k=0; k<t; k++ ) {
-		for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) {
-			x[i][j] = (x_ref(x,i+1,j,n)+x_ref(x,i-1,j,n)+x_ref(x,i,j+1,n)+x_ref(x,i,j-1,n)-h2*b[i][j]) / 4.0;
+template <class T> static inline double dotRow( const T *x, const T *y, int n ) {
+	double ans = 0.0;
+	for( int j=0; j<n; j++ ) ans += x[j]*y[j];
+	return ans;
+}
+static inline double dotRow( const real *x, const real *y, int n ) {
+	return simd::kernels.dot(x,y,n);
+}
+
+template <class T> static inline void axpyRow( T *ans, const T *x, const T *y, T a, int n ) {
+	for( int j=0; j<n; j++ ) ans[j] = x[j]+a*y[j];
+}
+static inline void axpyRow( real *ans, const real *x, const real *y, real a, int n ) {
+	simd::kernels.axpy(ans,x,y,a,n);
+}
+
+#ifndef USE_FLOAT
+// The Mixed Precision Correction Cycles Run In float, On The float simd Path
+static inline void laplacianRow( float *a, const float *xm, const float *x0, const float *xp, float h2, int n ) {
+	simd::kernels_f.laplacian(a,xm,x0,xp,h2,n);
+}
+static inline void residualRow( float *r, const float *b, const float *xm, const float *x0, const float *xp, float h2, int n ) {
+	simd::kernels_f.residual(r,b,xm,x0,xp,h2,n);
+}
+static inline void relaxRow( float *x0, const float *xm, const float *xp, const float *b, float h2, int from, int to, int parity ) {
+	simd::kernels_f.relax(x0,xm,xp,b,h2,from,to,parity);
+}
+#endif
+
+// Fused Conjugate Gradient Kernels
+// Each One Is a Single Pass Over Its Grids, The Dot Products Ride Along With The Writes
+// Traffic Per CG Iteration In n x n Grid Sweeps ( Each Read Or Write of a Field Counts One )
+#define CG_FUSED_SWEEPS		11		// Ap+pAp 2, x/r+rr 6, p 3
+#define CG_UNFUSED_SWEEPS	15		// Ax 2, pAp 2, rr 1, x 3, r 3, rr 1, p 3
+
+// Ap = A p, RETURN: p^T Ap
+template <class T> static double applyA( Grid2DT<T> p, Grid2DT<T> Ap, int n ) {
+	T h2 = 1.0/(n*n);
+	double pAp = 0.0;
+	fillHalo(p,n,n,HALO_CLAMP);
+	OPENMP_FOR_SUM(pAp)
+	for( int i=0; i<n; i++ ) {
+		// The Row Just Written Is Still In L1 For The Dot Product
+		laplacianRow( Ap[i], p[i-1], p[i], p[i+1], h2, n );
+		pAp += dotRow( p[i], Ap[i], n );
+	}
+	return pAp;
+}
+
+// x = x + a*p, r = r - a*Ap - mean, RETURN: r^T r With The Constant Part Removed
+// A r Sums To Zero, So Only Rounding Gives r a Constant Part. Its Sum Rides Along With r^T r
+// And Comes Back In mean, Removed By The Next Call ( One Iteration Late, It Never Builds Up )
+template <class T> static double update( Grid2DT<T> x, Grid2DT<T> r, Grid2DT<T> p, Grid2DT<T> Ap, double a, double &mean, int n ) {
+	T ta = a;
+	T tb = -a;
+	T tm = mean;
+	double rr = 0.0;
+	double sum = 0.0;
+	OPENMP_FOR_SUM(rr,sum)
+	for( int i=0; i<n; i++ ) {
+		T *x0 = x[i];
+		T *r0 = r[i];
+		const T *p0 = p[i];
+		const T *a0 = Ap[i];
+		for( int j=0; j<n; j++ ) {
+			x0[j] = x0[j]+ta*p0[j];
+			r0[j] = r0[j]+tb*a0[j]-tm;
+			rr += r0[j]*r0[j];
+			sum += r0[j];
 		}
 	}
+	mean = sum/((double)n*n);
+	return rr-sum*mean;
 }
 
-// ans = x^T * x
-static double product( double **x, double **y, int n ) {
-	double ans = 0.0;
+// Pipelined Conjugate Gradient Kernel ( Ghysels And Vanroose )
+// Classic CG Needs p^T Ap Before It Can Update r, So Each Iteration Has Two Reductions
+// In a Row. Here Both Dot Products Come From The Vectors Being Written, Which Leaves
+// One Parallel Loop And One Reduction Per Iteration, Computed Alongside q = A w
+// Traffic In n x n Grid Sweeps: Read w z s p x r 6, Write z s p x r w 6
+#define CG_PIPELINED_SWEEPS	12
+
+// Residual Replacement ( Cools And Van Der Vorst, For Pipelined CG )
+// The Recurrences For r, w, s And z Pick Up Rounding Every Step, And In float r Drifts Far Enough
+// From b-Ax That The Solve Stalls. Every CG_REPLACE Iterations, And Whenever r Looks Converged,
+// All Four Are Recomputed From x And p, And Only That Residual Can End The Solve
+#define CG_REPLACE			20
+#define CG_REPLACE_SWEEPS	13		// r 3, project 3, r^T r 1, A r 2, A p 2, A s 2
+
+// q = A w, z = q + b*z, s = w + b*s, p = r - mean + b*p, x = x + a*p, r = r - mean - a*s, wn = w - a*z
+// RETURN: rr = r^T r And wr = wn^T r ( Of The Updated Vectors ), mean of r For The Next Step ( See update )
+template <class T> static void pipeStep( Grid2DT<T> x, Grid2DT<T> r, Grid2DT<T> p, Grid2DT<T> s, Grid2DT<T> z,
+										 Grid2DT<T> w, Grid2DT<T> wn, double a, double b, int n, double &rr, double &wr, double &mean ) {
+	T h2 = 1.0/(n*n);
+	T ta = a;
+	T tb = b;
+	T tm = mean;
+	double sum_rr = 0.0;
+	double sum_wr = 0.0;
+	double sum_r = 0.0;
+	fillHalo(w,n,n,HALO_CLAMP);
+	OPENMP_FOR_SUM(sum_rr,sum_wr,sum_r)
 	for( int i=0; i<n; i++ ) {
+		const T *wm = w[i-1];
+		const T *w0 = w[i];
+		const T *wp = w[i+1];
+		T *x0 = x[i];
+		T *r0 = r[i];
+		T *p0 = p[i];
+		T *s0 = s[i];
+		T *z0 = z[i];
+		T *wn0 = wn[i];
+		// Three Loops Over The Same Row, Few Enough Pointers For The Compiler To Vectorize Each
+		for( int j=0; j<n; j++ ) {
+			z0[j] = (wp[j]+wm[j]+w0[j+1]+w0[j-1]-4*w0[j])/h2+tb*z0[j];
+		}
 		for( int j=0; j<n; j++ ) {
-			ans += x[i][j]*y[i][j];
+			s0[j] = w0[j]+tb*s0[j];
+			wn0[j] = w0[j]-ta*z0[j];
+		}
+		for( int j=0; j<n; j++ ) {
+			T rm = r0[j]-tm;
+			p0[j] = rm+tb*p0[j];
+			x0[j] = x0[j]+ta*p0[j];
+			r0[j] = rm-ta*s0[j];
+			sum_rr += r0[j]*r0[j];
+			sum_wr += wn0[j]*r0[j];
+			sum_r += r0[j];
+		}
+	}
+	mean = sum_r/((double)n*n);
+	rr = sum_rr-sum_r*mean;
+	wr = sum_wr;
+}
+
+// Red-Black Gauss-Seidel Iteration
+// Cells With i+j Even Are Red, Odd Are Black. A Color Only Reads The Other One,
+// So Rows Update In Parallel And Each Row Is a Stride-2 Loop The Compiler Vectorizes
+// The Halo Only Ever Mirrors The Cell Being Updated, So One Fill Per Sweep Is Exact
+// reverse Runs Black Before Red ( Post-Smoothing of a Symmetric Cycle )
+template <class T> static void gaussseidel( Grid2DT<T> x, Grid2DT<T> b, int n, int t, bool reverse=false ) {
+	T h2 = 1.0/(n*n);
+	for( int k=0; k<t; k++ ) {
+		fillHalo(x,n,n,HALO_CLAMP);
+		for( int pass=0; pass<2; pass++ ) {
+			int color = reverse ? 1-pass : pass;
+			OPENMP_FOR
+			for( int i=0; i<n; i++ ) relaxRow( x[i], x[i-1], x[i+1], b[i], h2, 0, n, (i+color)&1 );
+		}
+	}
+}
+
+// Temporally Blocked Red-Black Gauss-Seidel ( t Sweeps In One Pass Over x And b )
+// Columns Go In Strips of GS_WAVE_WIDTH, Each Shifted Left One Column Per Half Sweep So The Strip
+// To The Left Is Always Ahead. Inside a Strip, Half Sweep h ( Red, Black, Red, ... ) Works On Row
+// L-2h At Wavefront Step L. It Needs h-1 Done On The Row Above, Which Step L-1 Did, And No Two Rows
+// of a Step Touch, So They Run In Parallel. Every Cell Sees The Same Values As In gaussseidel, While
+// Only About 4t Strip Rows of x And b Have To Stay In Cache
+// The Halo Is Refreshed Per Row Since Rows Are At Different Sweeps
+#define GS_WAVE_WIDTH	512
+template <class T> static void gaussseidelWave( Grid2DT<T> x, Grid2DT<T> b, int n, int t ) {
+	T h2 = 1.0/(n*n);
+	int halves = 2*t;
+	int steps = n+2*(halves-1);
+	OPENMP_BEGIN
+	for( int J=0; J<n+halves; J+=GS_WAVE_WIDTH ) {
+		for( int L=0; L<steps; L++ ) {
+			OPENMP_FOR_P
+			for( int h=0; h<halves; h++ ) {
+				int i = L-2*h;
+				int j0 = max(J-h,0);
+				int j1 = min(J+GS_WAVE_WIDTH-h,n);
+				if( i < 0 || i >= n || j0 >= j1 ) continue;
+				T *x0 = x[i];
+				if( j0 == 0 ) x0[-1] = x0[0];
+				if( j1 == n ) x0[n] = x0[n-1];
+				if( i == 0 ) for( int j=j0; j<j1; j++ ) x[-1][j] = x0[j];
+				if( i == n-1 ) for( int j=j0; j<j1; j++ ) x[n][j] = x0[j];
+				relaxRow( x0, x[i-1], x[i+1], b[i], h2, j0, j1, (i+h)&1 );
+			}
 		}
 	}
+	OPENMP_END
+}
+
+// ans = x^T * x
+template <class T> static double product( Grid2DT<T> x, Grid2DT<T> y, int n ) {
+	double ans = 0.0;
+	for( int i=0; i<n; i++ ) ans += dotRow( x[i], y[i], n );
 	return ans;
 }
 
 // x = 0
-static void clear( double **x, int n ) {
+template <class T> static void clear( Grid2DT<T> x, int n ) {
 	for( int i=0; i<n; i++ ) {
 		for( int j=0; j<n; j++ ) {
-			x[i][j] = 0.0;
+			x[i][j] = 0;
 		}
 	}
 }
 
 // x <= y
-static void copy( double **x, double **y, int n ) {
+template <class T> static void copy( Grid2DT<T> x, Grid2DT<T> y, int n ) {
 	for( int i=0; i<n; i++ ) {
 		for( int j=0; j<n; j++ ) {
 			x[i][j] = y[i][j];
@@ -66,83 +356,266 @@ static void copy( double **x, double **y, int n ) {
 	}
 }
 				 
-// Ans = x + a*y
-static void op( double **x, double **y, double **ans, double a, int n ) {
-	static double **tmp = alloc2D(n);
+// Ans = x + a*y ( ans May Alias x or y )
+template <class T> static void op( Grid2DT<T> x, Grid2DT<T> y, Grid2DT<T> ans, double a, int n ) {
+	T ta = a;
+	for( int i=0; i<n; i++ ) axpyRow( ans[i], x[i], y[i], ta, n );
+}
+
+// |r| With The Constant Part Removed, Divided By n^2 ( One Pass )
+template <class T> static double norm( Grid2DT<T> r, int n ) {
+	double sum = 0.0;
+	double sq = 0.0;
+	OPENMP_FOR_SUM(sum,sq)
 	for( int i=0; i<n; i++ ) {
+		const T *r0 = r[i];
 		for( int j=0; j<n; j++ ) {
-			tmp[i][j] = x[i][j]+a*y[i][j];
+			sum += r0[j];
+			sq += r0[j]*r0[j];
+		}
+	}
+	double var = sq-sum*sum/((double)n*n);
+	return sqrt(var > 0.0 ? var : 0.0)/(n*n);
+}
+
+// r = r - Mean of r ( The Part Nothing Can Cancel, A Is Singular )
+template <class T> static void project( Grid2DT<T> r, int n ) {
+	double sum = 0.0;
+	OPENMP_FOR_SUM(sum)
+	for( int i=0; i<n; i++ ) {
+		const T *r0 = r[i];
+		for( int j=0; j<n; j++ ) sum += r0[j];
+	}
+	T mean = sum/((double)n*n);
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) {
+		T *r0 = r[i];
+		for( int j=0; j<n; j++ ) r0[j] -= mean;
+	}
+}
+
+// Lexicographic Gauss-Seidel Iteration ( Row By Row, Each Cell Sees Its Updated Neighbors )
+// Converges Faster Per Sweep Than Red-Black But Runs On One Thread
+// reverse Sweeps From The Last Cell Back ( Post-Smoothing of a Symmetric Cycle )
+template <class T> static void gaussseidelLex( Grid2DT<T> x, Grid2DT<T> b, int n, int t, bool reverse=false ) {
+	T h2 = 1.0/(n*n);
+	for( int k=0; k<t; k++ ) {
+		fillHalo(x,n,n,HALO_CLAMP);
+		for( int ii=0; ii<n; ii++ ) {
+			int i = reverse ? n-1-ii : ii;
+			const T *xm = x[i-1];
+			T *x0 = x[i];
+			const T *xp = x[i+1];
+			const T *b0 = b[i];
+			for( int jj=0; jj<n; jj++ ) {
+				int j = reverse ? n-1-jj : jj;
+				x0[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-h2*b0[j]) / 4;
+			}
+		}
+	}
+}
+
+// Chebyshev Settings
+#define CHEB_POWER		20		// Power Iterations For The Largest Eigenvalue
+#define CHEB_SAFETY		1.1		// Upper Bound = CHEB_SAFETY * Estimate ( Power Iteration Undershoots )
+#define CHEB_RATIO		6.0		// Damped Interval [ Upper/CHEB_RATIO, Upper ], The Modes Coarser Levels Can't See
+
+// Level of The mgv Hierarchy With Size n
+template <class T> static int depthOf( solver::Plan *plan, int n ) {
+	int l = 0;
+	for( int ln=scratch<T>(plan).top_n; ln!=n; ln=coarsen(ln) ) l ++;
+	return l;
+}
+
+// Largest Eigenvalue of D^-1 A On an n x n Level ( D = -4/h^2, The Diagonal Jacobi Uses )
+// Power Iteration From a Fixed Rough Vector, Using The Level's Smoother Scratch
+template <class T> static double largestEigen( Grid2DT<T> v, Grid2DT<T> Av, int n ) {
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) v[i][j] = ((i*7+j*13)%17)/17.0;
+	project( v, n );
+	double scale = -1.0/(4.0*n*n);
+	double lambda = 0.0;
+	for( int k=0; k<CHEB_POWER; k++ ) {
+		double vv = product( v, v, n );
+		if( ! vv ) return 0.0;
+		lambda = scale*applyA( v, Av, n )/vv;		// Rayleigh Quotient v^T D^-1 A v / v^T v
+		T c = scale/sqrt(vv);
+		for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) v[i][j] = c*Av[i][j];	// v = D^-1 A v / |v|
+	}
+	return lambda;
+}
+
+// Chebyshev Accelerated Jacobi Iteration ( Degree t Polynomial In D^-1 A )
+// Every Step Is a Jacobi Residual Pass And a Pointwise Update, With No Ordering Between Cells,
+// So Both Passes Run Fully In Parallel And Vectorize. The Polynomial Is Smallest Over The Upper
+// Part of The Spectrum, Estimated Per Level When The Plan Is Made. It Is Symmetric, So reverse Changes Nothing
+template <class T> static void chebyshev( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n, int t ) {
+	Scratch<T> &s = scratch<T>(plan);
+	int l = depthOf<T>(plan,n);
+	Grid2DT<T> r = s.cheb_r[l];
+	Grid2DT<T> d = s.cheb_d[l];
+	double upper = s.cheb_max[l];
+	if( upper <= 0 ) return;
+	double lower = upper/CHEB_RATIO;
+	double theta = (upper+lower)/2;
+	double delta = (upper-lower)/2;
+	double sigma = theta/delta;
+	double rho = 1.0/sigma;
+	
+	T h2 = 1.0/(n*n);
+	for( int k=0; k<t; k++ ) {
+		// r = D^-1 (b-Ax)
+		fillHalo(x,n,n,HALO_CLAMP);
+		OPENMP_FOR
+		for( int i=0; i<n; i++ ) {
+			const T *xm = x[i-1];
+			const T *x0 = x[i];
+			const T *xp = x[i+1];
+			const T *b0 = b[i];
+			T *r0 = r[i];
+			for( int j=0; j<n; j++ ) {
+				r0[j] = (xp[j]+xm[j]+x0[j+1]+x0[j-1]-h2*b0[j])/4-x0[j];
+			}
+		}
+		
+		// d = c1*d + c2*r, x = x + d
+		double rho_next = k ? 1.0/(2*sigma-rho) : rho;
+		T c1 = k ? rho_next*rho : 0.0;
+		T c2 = k ? 2*rho_next/delta : 1.0/theta;
+		rho = rho_next;
+		OPENMP_FOR
+		for( int i=0; i<n; i++ ) {
+			T *x0 = x[i];
+			T *d0 = d[i];
+			const T *r0 = r[i];
+			if( k ) for( int j=0; j<n; j++ ) d0[j] = c1*d0[j]+c2*r0[j];
+			else for( int j=0; j<n; j++ ) d0[j] = c2*r0[j];
+			for( int j=0; j<n; j++ ) x0[j] += d0[j];
 		}
 	}
-	copy(ans,tmp,n);
 }
 
-static void smooth( double **x, double **b, int n, int t ) {
-	// Smooth Using Gaus-Seidel Method
-	gaussseidel( x, b, n, t );
+// Smooth With The Chosen Smoother ( solver::setSmoother )
+template <class T> static void smooth( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n, int t, bool reverse=false ) {
+	switch( plan->smoother ) {
+		case SMOOTH_GS:
+			gaussseidelLex( x, b, n, t, reverse );
+			break;
+		case SMOOTH_CHEBYSHEV:
+			chebyshev( plan, x, b, n, t );
+			break;
+		default:
+			gaussseidel( x, b, n, t, reverse );
+			break;
+	}
+}
+
+// r = b - Ax ( One Pass )
+template <class T> static void residual( Grid2DT<T> x, Grid2DT<T> b, Grid2DT<T> r, int n ) {
+	T h2 = 1.0/(n*n);
+	fillHalo(x,n,n,HALO_CLAMP);
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) residualRow( r[i], b[i], x[i-1], x[i], x[i+1], h2, n );
+}
+
+// norm(b - Ax) ( Through The Scratch Residual )
+template <class T> static double residualNorm( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Grid2DT<T> r = scratch<T>(plan).r;
+	residual( x, b, r, n );
+	return norm( r, n );
+}
+
+// Coarse Levels Are Discretized With h = 1/cn, But Below An Odd Level It Really Is 2h = 2/fn
+// Restriction Scales The Residual By (2cn/fn)^2 To Make Up For It ( 1 For Even fn )
+static double coarseScale( int fn ) {
+	double cn = coarsen(fn);
+	return 4.0*cn*cn/((double)fn*fn);
+}
+
+// Restriction From an Odd Level ( fn = 2cn-1 )
+// Coarse Cell I Is Centered On Fine Cell 2I, So The Coarse Grid Overhangs The Domain By
+// Half a Fine Cell On Both Sides. Weights (1,2,1)/4 Per Axis, The Overhang Holds No Residual
+template <class T> static void restrictOdd( Grid2DT<T> fine, Grid2DT<T> coarse, int fn ) {
+	int cn = coarsen(fn);
+	T w = coarseScale(fn)/16;
+	fillHalo(fine,fn,fn,HALO_ZERO);
+	OPENMP_FOR
+	for( int i=0; i<cn; i++ ) {
+		const T *f0 = fine[2*i-1];
+		const T *f1 = fine[2*i];
+		const T *f2 = fine[2*i+1];
+		T *c = coarse[i];
+		for( int j=0; j<cn; j++ ) {
+			int k = 2*j;
+			T r0 = f0[k-1]+2*f0[k]+f0[k+1];
+			T r1 = f1[k-1]+2*f1[k]+f1[k+1];
+			T r2 = f2[k-1]+2*f2[k]+f2[k+1];
+			c[j] = (r0+2*r1+r2)*w;
+		}
+	}
 }
 
-// r = b - Ax
-static void residual( double **x, double **b, double **r, int n ) {
-	compute_Ax(x,r,n);
-	op( b, r, r, -1.0, n );
+// Linear Prolongation To an Odd Level ( fine = fine + P * coarse, Transpose of restrictOdd )
+template <class T> static void prolongOdd( Grid2DT<T> coarse, Grid2DT<T> fine, int fn ) {
+	OPENMP_FOR
+	for( int i=0; i<fn; i++ ) {
+		const T *c0 = coarse[i/2];
+		const T *c1 = coarse[(i+1)/2];
+		T *f = fine[i];
+		for( int j=0; j<fn; j++ ) {
+			int j0 = j/2;
+			int j1 = (j+1)/2;
+			f[j] += (c0[j0]+c0[j1]+c1[j0]+c1[j1])/4;
+		}
+	}
 }
 
-// Shrink the image
-static void shrink( double **fine, double **coarse, int fn ) {
+// Shrink the image ( Average of 2x2 Cells, Or restrictOdd )
+// Kept Piecewise For mgv: Full Weighting And Bilinear Prolongation ( restrictFW, prolongAdd ) Took
+// 3 V-Cycles a Frame Instead of 2 Here ( fullMultigrid Uses Those )
+template <class T> static void shrink( Grid2DT<T> fine, Grid2DT<T> coarse, int fn ) {
+	if( fn%2 ) {
+		restrictOdd(fine,coarse,fn);
+		return;
+	}
 	for( int i=0; i<fn/2; i++ ) {
 		for( int j=0; j<fn/2; j++ ) {
-			// TODO: Interpolate Smoothly.
-			coarse[i][j] = (fine[2*i][2*j]+fine[2*i+1][2*j]+fine[2*i][2*j+1]+fine[2*i+1][2*j+1]) / 4.0;
+			coarse[i][j] = (fine[2*i][2*j]+fine[2*i+1][2*j]+fine[2*i][2*j+1]+fine[2*i+1][2*j+1]) / 4;
 		}
 	}
 }
 
-// Expand the image
-static void expand( double **coarse, double **fine, int fn ) {
+// Expand the image ( Piecewise Constant, Or prolongOdd )
+template <class T> static void expand( Grid2DT<T> coarse, Grid2DT<T> fine, int fn ) {
+	if( fn%2 ) {
+		clear(fine,fn);
+		prolongOdd(coarse,fine,fn);
+		return;
+	}
 	for( int i=0; i<fn; i++ ) {
 		for( int j=0; j<fn; j++ ) {
-			// TODO: Interpolate Smoothly
 			fine[i][j] = coarse[i/2][j/2];
 		}
 	}
 }
 
-// (V-Cycle Only) Multigrid Method
-// TODO: Might Be Better Implement Full Multigrid Method
-#define MAX_LAYER		8
-static void mgv( double **x, double **b, int n, int recr=0 ) {
-	
-	// Memory Saving Part
-	static double **fine_r[MAX_LAYER];
-	static double **fine_e[MAX_LAYER];
-	static double **coarse_r[MAX_LAYER];
-	static double **coarse_e[MAX_LAYER];
-	static double initialized = false;
-	if( ! initialized  ) {
-		for( int n=0; n<MAX_LAYER; n++ ) {
-			fine_r[n] = NULL;
-			fine_e[n] = NULL;
-			coarse_r[n] = NULL;
-			coarse_e[n] = NULL;
-		}
-		initialized = true;
-	}
+// (V-Cycle Only) Multigrid Method ( See fullMultigrid For The Other Cycles )
+template <class T> static void mgv( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n, int recr=0 ) {
 	
-	if( ! fine_r[recr] ) fine_r[recr] = alloc2D(n);
-	if( ! fine_e[recr] ) fine_e[recr] = alloc2D(n);
-	if( ! coarse_r[recr] ) coarse_r[recr] = alloc2D(n/2);
-	if( ! coarse_e[recr] ) coarse_e[recr] = alloc2D(n/2);
+	Grid2DT<T> *fine_r = scratch<T>(plan).fine_r;
+	Grid2DT<T> *fine_e = scratch<T>(plan).fine_e;
+	Grid2DT<T> *coarse_r = scratch<T>(plan).coarse_r;
+	Grid2DT<T> *coarse_e = scratch<T>(plan).coarse_e;
 	
+	int cn = coarsen(n);
 	clear(fine_r[recr],n);
 	clear(fine_e[recr],n);
-	clear(coarse_r[recr],n/2);
-	clear(coarse_e[recr],n/2);
+	clear(coarse_r[recr],cn);
+	clear(coarse_e[recr],cn);
 	
 ///////////// Beginning of V-Cycle
 	
 	// Pre-smoothing
-	smooth( x, b, n, 4 );
+	smooth( plan, x, b, n, 4 );
 	
 	// Compute Residual
 	residual( x, b, fine_r[recr], n );
@@ -151,11 +624,11 @@ static void mgv( double **x, double **b, int n, int recr=0 ) {
 	shrink(fine_r[recr],coarse_r[recr],n);
 
 	if( n <= 2 ) {
-		// TODO: Should Be Solved Exactly
-		smooth( coarse_e[recr], coarse_r[recr], n/2, 10 );
+		// The 1 x 1 Level Only Holds The Constant Mode, Its Exact Correction Is Zero
+		// ( Smoothing It Just Walked x Off By a Constant Every Cycle )
 	} else {
 		// Recursively Call Itself
-		mgv(coarse_e[recr],coarse_r[recr],n/2,recr+1);
+		mgv(plan,coarse_e[recr],coarse_r[recr],cn,recr+1);
 	}
 	
 	// Interpolate
@@ -165,58 +638,1244 @@ static void mgv( double **x, double **b, int n, int recr=0 ) {
 	op( x, fine_e[recr], x, 1.0, n );
 	
 	// Post-smoothing
-	smooth( x, b, n, 4 );
+	smooth( plan, x, b, n, 4 );
+}
+
+// Full Weighting Restriction ( Transpose of Bilinear Prolongation )
+// Each Coarse Cell Averages The 4x4 Fine Cells Around It, Weights (1,3,3,1)/8 Per Axis
+template <class T> static void restrictFW( Grid2DT<T> fine, Grid2DT<T> coarse, int fn ) {
+	if( fn%2 ) {
+		restrictOdd(fine,coarse,fn);
+		return;
+	}
+	fillHalo(fine,fn,fn,HALO_CLAMP);
+	OPENMP_FOR
+	for( int i=0; i<fn/2; i++ ) {
+		const T *f0 = fine[2*i-1];
+		const T *f1 = fine[2*i];
+		const T *f2 = fine[2*i+1];
+		const T *f3 = fine[2*i+2];
+		T *c = coarse[i];
+		for( int j=0; j<fn/2; j++ ) {
+			int k = 2*j;
+			T r0 = f0[k-1]+3*f0[k]+3*f0[k+1]+f0[k+2];
+			T r1 = f1[k-1]+3*f1[k]+3*f1[k+1]+f1[k+2];
+			T r2 = f2[k-1]+3*f2[k]+3*f2[k+1]+f2[k+2];
+			T r3 = f3[k-1]+3*f3[k]+3*f3[k+1]+f3[k+2];
+			c[j] = (r0+3*r1+3*r2+r3)/64;
+		}
+	}
+}
+
+// Bilinear Prolongation ( fine = fine + P * coarse )
+// A Fine Cell Takes 9/16 of Its Parent, 3/16 of The Two Nearest Neighbors And 1/16 of The Diagonal
+template <class T> static void prolongAdd( Grid2DT<T> coarse, Grid2DT<T> fine, int fn ) {
+	if( fn%2 ) {
+		prolongOdd(coarse,fine,fn);
+		return;
+	}
+	int cn = fn/2;
+	fillHalo(coarse,cn,cn,HALO_CLAMP);
+	OPENMP_FOR
+	for( int i=0; i<fn; i++ ) {
+		const T *c0 = coarse[i/2];
+		const T *c1 = coarse[i%2 ? i/2+1 : i/2-1];
+		T *f = fine[i];
+		for( int j=0; j<cn; j++ ) {
+			f[2*j] += (9*c0[j]+3*c1[j]+3*c0[j-1]+c1[j-1])/16;
+			f[2*j+1] += (9*c0[j]+3*c1[j]+3*c0[j+1]+c1[j+1])/16;
+		}
+	}
+}
+
+// Factor The Coarsest Level Once
+// A Is Singular ( Constants ), So Solve With G = h2*( 11^T - A ) Instead, Which Is SPD
+// And Gives The Zero Mean Solution of Ax = b For Any Zero Mean b
+static void factorCoarse( double *L, int n ) {
+	int m = n*n;
+	for( int k=0; k<m*m; k++ ) L[k] = 1.0;
+	for( int i=0; i<n; i++ ) {
+		for( int j=0; j<n; j++ ) {
+			int k = i*n+j;
+			int nbrs[4][2] = { {i-1,j}, {i+1,j}, {i,j-1}, {i,j+1} };
+			int count = 0;
+			for( int q=0; q<4; q++ ) {
+				int ni = nbrs[q][0];
+				int nj = nbrs[q][1];
+				if( ni < 0 || ni >= n || nj < 0 || nj >= n ) continue;
+				L[k*m+ni*n+nj] = 0.0;
+				count ++;
+			}
+			L[k*m+k] = count+1.0;
+		}
+	}
+	
+	// In Place Cholesky ( Lower Triangle )
+	for( int j=0; j<m; j++ ) {
+		double d = L[j*m+j];
+		for( int k=0; k<j; k++ ) d -= L[j*m+k]*L[j*m+k];
+		d = sqrt(d);
+		L[j*m+j] = d;
+		for( int i=j+1; i<m; i++ ) {
+			double v = L[i*m+j];
+			for( int k=0; k<j; k++ ) v -= L[i*m+k]*L[j*m+k];
+			L[i*m+j] = v/d;
+		}
+	}
+}
+
+// Solve The Coarsest Level Exactly ( Up To The Nullspace )
+template <class T> static void coarseSolve( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	int m = n*n;
+	double h2 = 1.0/(n*n);
+	double mean = 0.0;
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) mean += b[i][j];
+	mean /= m;
+	
+	// G x = -h2*(b-mean)
+	double *y = plan->coarse_y;
+	const double *L = plan->coarse_L;
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) y[i*n+j] = -h2*(b[i][j]-mean);
+	for( int i=0; i<m; i++ ) {
+		double v = y[i];
+		for( int k=0; k<i; k++ ) v -= L[i*m+k]*y[k];
+		y[i] = v/L[i*m+i];
+	}
+	for( int i=m-1; i>=0; i-- ) {
+		double v = y[i];
+		for( int k=i+1; k<m; k++ ) v -= L[k*m+i]*y[k];
+		y[i] = v/L[i*m+i];
+	}
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) x[i][j] = y[i*n+j];
+}
+
+// One Multigrid Cycle For Ax = b On level of The Hierarchy
+// V Visits Each Coarser Level Once, W Twice, F Once With an F And Then a V
+// symmetric Mirrors Pre-Smoothing In Post-Smoothing, So a V-Cycle From Zero Is a Symmetric Operator
+template <class T> static void cycle( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int level, int type, bool symmetric=false ) {
+	Scratch<T> &s = scratch<T>(plan);
+	int n = s.level_n[level];
+	
+	if( level == s.levels-1 ) {
+		coarseSolve(plan,x,b,n);
+		return;
+	}
+	
+	smooth( plan, x, b, n, FMG_PRE );
+	residual( x, b, s.level_r[level], n );
+	restrictFW( s.level_r[level], s.level_b[level+1], n );
+	clear( s.level_x[level+1], s.level_n[level+1] );
+	
+	Grid2DT<T> cx = s.level_x[level+1];
+	Grid2DT<T> cb = s.level_b[level+1];
+	cycle( plan, cx, cb, level+1, type, symmetric );
+	if( type == CYCLE_W ) cycle( plan, cx, cb, level+1, CYCLE_W, symmetric );
+	if( type == CYCLE_F ) cycle( plan, cx, cb, level+1, CYCLE_V, symmetric );
+	
+	prolongAdd( cx, x, n );
+	smooth( plan, x, b, n, FMG_POST, symmetric );
+}
+
+// Full Multigrid
+// Restricts The Residual All The Way Down, Solves The Coarsest Level Exactly, Then
+// Prolongs The Solution Up One Level At a Time With One Cycle On Each
+// Works On The Correction Ae = b-Ax, So a Nonzero Initial Guess Is Kept
+template <class T> static void fullMultigrid( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Scratch<T> &s = scratch<T>(plan);
+	int L = s.levels;
+	
+	residual( x, b, s.level_b[0], n );
+	for( int l=0; l<L-1; l++ ) {
+		restrictFW( s.level_b[l], s.level_b[l+1], s.level_n[l] );
+	}
+	coarseSolve( plan, s.level_x[L-1], s.level_b[L-1], s.level_n[L-1] );
+	
+	for( int l=L-2; l>=0; l-- ) {
+		clear( s.level_x[l], s.level_n[l] );
+		prolongAdd( s.level_x[l+1], s.level_x[l], s.level_n[l] );
+		cycle( plan, s.level_x[l], s.level_b[l], l, plan->cycle );
+	}
+	op( x, s.level_x[0], x, 1.0, n );
+}
+
+// z = M^-1 r With One Multigrid V-Cycle From Zero ( Symmetric Smoothing )
+template <class T> static void mgPrecond( solver::Plan *plan, Grid2DT<T> z, Grid2DT<T> r, int n ) {
+	clear( z, n );
+	cycle( plan, z, r, 0, CYCLE_V, true );
+}
+
+// Modified Incomplete Cholesky MIC(0) of The 5-Point Neumann Laplacian
+// Factored For A' = -h2*A ( Unit Stencil, Positive ), Stores 1/sqrt(Pivot) Per Cell
+// The Halo of diag Stays Zero, So Boundary Terms Drop Out Without Branches
+#define MIC_TAU			0.97
+#define MIC_SIGMA		0.25
+#define MIC_TILE		32		// Wavefront Block Size of The Triangular Solves
+template <class T> static void factorMIC( Grid2DT<T> diag, int n ) {
+	for( int i=0; i<n; i++ ) {
+		for( int j=0; j<n; j++ ) {
+			double Ad = (i>0)+(i<n-1)+(j>0)+(j<n-1);
+			double e = Ad;
+			if( i>0 ) {
+				double pc = diag[i-1][j];
+				e -= pc*pc*(1.0+MIC_TAU*(j<n-1));
+			}
+			if( j>0 ) {
+				double pc = diag[i][j-1];
+				e -= pc*pc*(1.0+MIC_TAU*(i<n-1));
+			}
+			if( e < MIC_SIGMA*Ad ) e = Ad;
+			diag[i][j] = e > 0.0 ? 1.0/sqrt(e) : 0.0;
+		}
+	}
+}
+
+// Forward ( Lq = r ) Or Backward ( L^T z = q ) Solve of One Block, In Place In z
+template <class T> static void micBlock( Grid2DT<T> z, Grid2DT<T> r, Grid2DT<T> diag, int i0, int i1, int j0, int j1, bool forward ) {
+	if( forward ) {
+		for( int i=i0; i<i1; i++ ) {
+			const T *zm = z[i-1];
+			const T *dm = diag[i-1];
+			const T *d0 = diag[i];
+			const T *r0 = r[i];
+			T *z0 = z[i];
+			for( int j=j0; j<j1; j++ ) {
+				z0[j] = (r0[j]+dm[j]*zm[j]+d0[j-1]*z0[j-1])*d0[j];
+			}
+		}
+	} else {
+		for( int i=i1-1; i>=i0; i-- ) {
+			const T *zp = z[i+1];
+			const T *d0 = diag[i];
+			T *z0 = z[i];
+			for( int j=j1-1; j>=j0; j-- ) {
+				z0[j] = (z0[j]+d0[j]*(zp[j]+z0[j+1]))*d0[j];
+			}
+		}
+	}
 }
 
-static void conjGrad( double **x, double **b, int n ) {
-	// Pre-allocate Memory
-	static double **r = alloc2D(n);
-	static double **p = alloc2D(n);
-	static double **Ap = alloc2D(n);
-	clear(r,n);
-	clear(p,n);
-	clear(Ap,n);
+// z = M^-1 r With The MIC(0) Factor of The Plan
+// Block (I,J) Only Depends On (I-1,J) And (I,J-1), So Blocks On One Anti-Diagonal
+// Run In Parallel And The Result Matches The Serial Lexicographic Solve Exactly
+template <class T> static void micPrecond( solver::Plan *plan, Grid2DT<T> z, Grid2DT<T> r, int n ) {
+	Grid2DT<T> diag = scratch<T>(plan).mic;
+	
+	int tiles = (n+MIC_TILE-1)/MIC_TILE;
+	fillHalo(z,n,n,HALO_ZERO);
+	for( int pass=0; pass<2; pass++ ) {
+		bool forward = pass == 0;
+		for( int w=0; w<2*tiles-1; w++ ) {
+			int wave = forward ? w : 2*tiles-2-w;
+			OPENMP_FOR
+			for( int I=max(0,wave-tiles+1); I<=min(wave,tiles-1); I++ ) {
+				int J = wave-I;
+				micBlock( z, r, diag, I*MIC_TILE, min(n,(I+1)*MIC_TILE), J*MIC_TILE, min(n,(J+1)*MIC_TILE), forward );
+			}
+		}
+	}
+	
+	// Back To The Scale And Sign of A. MIC Keeps The Zero Row Sums of A, So M Is Nearly
+	// Singular Too And z Picks Up a Large Constant, Which Is Removed Here
+	double mean = 0.0;
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) mean += z[i][j];
+	mean /= n*n;
+	T s = -1.0/(n*n);
+	T m = mean;
+	for( int i=0; i<n; i++ ) for( int j=0; j<n; j++ ) z[i][j] = s*(z[i][j]-m);
+}
+
+// Preconditioned Conjugate Gradient
+template <class T> static void pcg( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n, void (*precond)( solver::Plan *plan, Grid2DT<T> z, Grid2DT<T> r, int n ) ) {
+	Grid2DT<T> r = scratch<T>(plan).r;
+	Grid2DT<T> p = scratch<T>(plan).p;
+	Grid2DT<T> Ap = scratch<T>(plan).Ap;
+	Grid2DT<T> z = scratch<T>(plan).z;
+	
+	residual( x, b, r, n );					// r = b-Ax
+	project( r, n );
+	double rr = product( r, r, n );
+	if( finished(plan,sqrt(rr)/(n*n)) ) return;
+	precond( plan, z, r, n );				// z = M^-1 r
+	copy( p, z, n );						// p = z
+	double rz = product( r, z, n );
+	double mean = 0.0;
+	
+	for(;;) {
+		double pAp = applyA( p, Ap, n );	// Ap, p^T * Ap
+		if( ! pAp ) break;
+		double a = rz/pAp;					// a = r^T * z / p^T * Ap
+		rr = update( x, r, p, Ap, a, mean, n );	// x = x + a*p, r = r - a*Ap
+		plan->stats.iterations ++;
+		if( finished(plan,sqrt(rr)/(n*n)) ) break;
+		precond( plan, z, r, n );			// z = M^-1 r
+		double rz2 = product( r, z, n );
+		op( z, p, p, rz2/rz, n );			// p = z + b*p
+		rz = rz2;
+	}
+	
+	// The Recurrence Drifts, Report The True Residual
+	plan->stats.residual = residualNorm( plan, x, b, n );
+}
+
+// Conjugate Gradient With The Fused Kernels ( Three Passes Per Iteration )
+template <class T> static void conjGrad( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Grid2DT<T> r = scratch<T>(plan).r;
+	Grid2DT<T> p = scratch<T>(plan).p;
+	Grid2DT<T> Ap = scratch<T>(plan).Ap;
 	
 	residual( x, b, r, n );					// r = b-Ax
+	project( r, n );
 	copy( p, r, n );						// p = r
-	for( int k=0; k<n*n; k++ ) {
-		compute_Ax( p, Ap, n );				// Ap
-		double pAp = product( p, Ap, n );	// p^T * Ap
-		double rr1 = product( r, r, n );	// r^T * r
-		double a;
-		if( pAp ) { 
-			a = rr1/pAp;					// a = r^T * r / p^T * Ap
-		} else break;
-		op( x, p, x, a, n );				// x = x + a*p
-		op( r, Ap, r, -a, n );				// r = r - a*Ap
-		double rr2 = product( r, r, n );	// r1^T * r1
-		if( rr2/n < 1.0e-8 ) break;
-		if( rr1 ) {
-			double b = rr2/rr1;
-			op( r, p, p, b, n );			// p = r + b*p
-		}
-	}
-}
-
-double solver::solve( int method, int numiter, double **x, double **b, int n ) {
-	static double **r = alloc2D(n);
-	clear(r,n);
-	
-	switch(method) {
+	double rr1 = product( r, r, n );		// r^T * r
+	if( finished(plan,sqrt(rr1)/(n*n)) ) return;
+	double mean = 0.0;
+	for(;;) {
+		double pAp = applyA( p, Ap, n );	// Ap, p^T * Ap
+		if( ! pAp ) break;
+		double a = rr1/pAp;					// a = r^T * r / p^T * Ap
+		double rr2 = update( x, r, p, Ap, a, mean, n );	// x = x + a*p, r = r - a*Ap, r1^T * r1
+		plan->stats.iterations ++;
+		if( finished(plan,sqrt(rr2)/(n*n)) ) break;
+		op( r, p, p, rr2/rr1, n );			// p = r + b*p
+		rr1 = rr2;
+	}
+	plan->stats.residual = residualNorm( plan, x, b, n );
+}
+
+// Pipelined Conjugate Gradient ( One Pass And One Reduction Per Iteration )
+// Same Iterates As conjGrad In Exact Arithmetic. The Extra Recurrences Lose Accuracy,
+// So They Are Replaced Now And Then ( See CG_REPLACE ) And The Final Residual Is Recomputed From x
+template <class T> static void pipeCG( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Scratch<T> &sc = scratch<T>(plan);
+	Grid2DT<T> r = sc.r;
+	Grid2DT<T> p = sc.p;
+	Grid2DT<T> s = sc.Ap;					// s = A p
+	Grid2DT<T> z = sc.z;					// z = A s
+	int cur = 0;
+	
+	residual( x, b, r, n );					// r = b-Ax
+	project( r, n );
+	double wr = applyA( r, sc.w[cur], n );	// w = A r, r^T * w
+	double rr = product( r, r, n );			// r^T * r
+	if( finished(plan,sqrt(rr)/(n*n)) ) return;
+	clear( p, n );
+	clear( s, n );
+	clear( z, n );
+	
+	double a = 0.0;
+	double rr_old = 0.0;
+	double mean = 0.0;
+	for(;;) {
+		double beta = a ? rr/rr_old : 0.0;
+		double denom = a ? wr-beta*rr/a : wr;	// p^T A p, From The Recurrences
+		if( ! denom ) break;
+		a = rr/denom;
+		rr_old = rr;
+		pipeStep( x, r, p, s, z, sc.w[cur], sc.w[1-cur], a, beta, n, rr, wr, mean );
+		cur = 1-cur;
+		plan->stats.iterations ++;
+		if( plan->stats.iterations % CG_REPLACE && sqrt(rr)/(n*n) > plan->target ) {
+			// Budget Check Only, The Recurrence Is Above The Target
+			if( finished(plan,sqrt(rr)/(n*n)) ) break;
+			continue;
+		}
+		residual( x, b, r, n );				// r = b-Ax
+		project( r, n );
+		rr = product( r, r, n );
+		wr = applyA( r, sc.w[cur], n );		// w = A r, r^T * w
+		applyA( p, s, n );					// s = A p
+		applyA( s, z, n );					// z = A s
+		mean = 0.0;
+		if( finished(plan,sqrt(rr)/(n*n)) ) break;
+	}
+	plan->stats.residual = residualNorm( plan, x, b, n );
+}
+
+// Deflated Conjugate Gradient With Recycling ( Saad, Yeung, Erhel And Guyomarc'h )
+// Consecutive Frames Solve Nearly The Same System, And The Slow Part of Every CG Solve Is The
+// Same Few Smooth Modes. The Solver Keeps RECYCLE_K Vectors W Spanning Them And Runs CG In The
+// Complement: x Starts With Its W Part Solved Exactly, And Every Search Direction Is Kept
+// A-Orthogonal To W. Snapshots of x Along Each Solve Then Refine W For The Next One
+#define RECYCLE_K		4		// Recycled Vectors
+#define RECYCLE_M		8		// Snapshots of x Kept Per Solve
+#define RECYCLE_MAX		(RECYCLE_K+RECYCLE_M)
+
+// In Place Cholesky of an m x m Matrix ( Lower Triangle ), RETURN: Whether It Was Positive Definite
+static bool cholesky( double *L, int m ) {
+	for( int j=0; j<m; j++ ) {
+		double d = L[j*m+j];
+		for( int k=0; k<j; k++ ) d -= L[j*m+k]*L[j*m+k];
+		if( d <= 1e-14*fabs(L[j*m+j]) || d <= 0.0 ) return false;
+		d = sqrt(d);
+		L[j*m+j] = d;
+		for( int i=j+1; i<m; i++ ) {
+			double v = L[i*m+j];
+			for( int k=0; k<j; k++ ) v -= L[i*m+k]*L[j*m+k];
+			L[i*m+j] = v/d;
+		}
+	}
+	return true;
+}
+
+// y = (L L^T)^-1 y
+static void choleskySolve( const double *L, double *y, int m ) {
+	for( int i=0; i<m; i++ ) {
+		double v = y[i];
+		for( int k=0; k<i; k++ ) v -= L[i*m+k]*y[k];
+		y[i] = v/L[i*m+i];
+	}
+	for( int i=m-1; i>=0; i-- ) {
+		double v = y[i];
+		for( int k=i+1; k<m; k++ ) v -= L[k*m+i]*y[k];
+		y[i] = v/L[i*m+i];
+	}
+}
+
+// Eigenvalues ( Diagonal of C On Return ) And Eigenvectors ( Columns of V ) of a Symmetric m x m C
+// Cyclic Jacobi Rotations, Plenty For The Few Dozen Entries Here
+static void jacobiEigen( double *C, double *V, int m ) {
+	for( int i=0; i<m; i++ ) for( int j=0; j<m; j++ ) V[i*m+j] = i == j;
+	for( int sweep=0; sweep<50; sweep++ ) {
+		double off = 0.0;
+		double all = 0.0;
+		for( int i=0; i<m; i++ ) for( int j=0; j<m; j++ ) {
+			all += C[i*m+j]*C[i*m+j];
+			if( i != j ) off += C[i*m+j]*C[i*m+j];
+		}
+		if( off <= 1e-30*all ) break;
+		for( int p=0; p<m; p++ ) for( int q=p+1; q<m; q++ ) {
+			if( ! C[p*m+q] ) continue;
+			double theta = (C[q*m+q]-C[p*m+p])/(2*C[p*m+q]);
+			double t = (theta >= 0 ? 1.0 : -1.0)/(fabs(theta)+sqrt(theta*theta+1));
+			double c = 1.0/sqrt(t*t+1);
+			double s = t*c;
+			for( int k=0; k<m; k++ ) {
+				double kp = C[k*m+p];
+				double kq = C[k*m+q];
+				C[k*m+p] = c*kp-s*kq;
+				C[k*m+q] = s*kp+c*kq;
+			}
+			for( int k=0; k<m; k++ ) {
+				double pk = C[p*m+k];
+				double qk = C[q*m+k];
+				C[p*m+k] = c*pk-s*qk;
+				C[q*m+k] = s*pk+c*qk;
+			}
+			for( int k=0; k<m; k++ ) {
+				double kp = V[k*m+p];
+				double kq = V[k*m+q];
+				V[k*m+p] = c*kp-s*kq;
+				V[k*m+q] = s*kp+c*kq;
+			}
+		}
+	}
+}
+
+// mu = E^-1 (AW)^T r With E = W^T A W ( Negative Definite, -E Is Factored )
+static void deflateSolve( const double *L, const double *dots, double *mu, int k ) {
+	for( int q=0; q<k; q++ ) mu[q] = -dots[q];
+	choleskySolve( L, mu, k );
+}
+
+// x = x + a*p, r = r - a*Ap - mean, dots = (AW)^T r ( All In One Pass, See update )
+// RETURN: r^T r With The Constant Part Removed
+template <class T> static double deflateUpdate( Grid2DT<T> x, Grid2DT<T> r, Grid2DT<T> p, Grid2DT<T> Ap, double a, double &mean,
+												const Grid2DT<T> *AW, double *dots, int n ) {
+	T ta = a;
+	T tb = -a;
+	T tm = mean;
+	double rr = 0.0;
+	double sum = 0.0;
+	for( int q=0; q<RECYCLE_K; q++ ) dots[q] = 0.0;
+	OPENMP_BEGIN
+	double part[RECYCLE_K];
+	for( int q=0; q<RECYCLE_K; q++ ) part[q] = 0.0;
+	OPENMP_FOR_P_SUM(rr,sum)
+	for( int i=0; i<n; i++ ) {
+		T *x0 = x[i];
+		T *r0 = r[i];
+		const T *p0 = p[i];
+		const T *a0 = Ap[i];
+		for( int j=0; j<n; j++ ) {
+			x0[j] = x0[j]+ta*p0[j];
+			r0[j] = r0[j]+tb*a0[j]-tm;
+			rr += r0[j]*r0[j];
+			sum += r0[j];
+		}
+		// All Dot Products In One Sweep of The Row, So Their Additions Overlap
+		const T *w0[RECYCLE_K];
+		double d[RECYCLE_K];
+		for( int q=0; q<RECYCLE_K; q++ ) {
+			w0[q] = AW[q][i];
+			d[q] = 0.0;
+		}
+		for( int j=0; j<n; j++ ) {
+			for( int q=0; q<RECYCLE_K; q++ ) d[q] += w0[q][j]*r0[j];
+		}
+		for( int q=0; q<RECYCLE_K; q++ ) part[q] += d[q];
+	}
+	OPENMP_CRITICAL
+	for( int q=0; q<RECYCLE_K; q++ ) dots[q] += part[q];
+	OPENMP_END
+	mean = sum/((double)n*n);
+	return rr-sum*mean;
+}
+
+// p = r + b*p - W mu
+template <class T> static void deflateDirection( Grid2DT<T> r, Grid2DT<T> p, double b, const Grid2DT<T> *W, const double *mu, int k, int n ) {
+	T tb = b;
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) {
+		const T *r0 = r[i];
+		T *p0 = p[i];
+		const T *w0[RECYCLE_K];
+		T m[RECYCLE_K];
+		for( int q=0; q<RECYCLE_K; q++ ) {
+			w0[q] = W[q][i];
+			m[q] = q < k ? mu[q] : 0;
+		}
+		for( int j=0; j<n; j++ ) {
+			T v = r0[j]+tb*p0[j];
+			for( int q=0; q<RECYCLE_K; q++ ) v -= m[q]*w0[q][j];
+			p0[j] = v;
+		}
+	}
+}
+
+// A W And The Factor of -W^T A W For The Current Basis
+template <class T> static void factorRecycle( solver::Plan *plan, int n ) {
+	Scratch<T> &s = scratch<T>(plan);
+	int k = s.rec_k;
+	double *L = s.rec_L;
+	for( int q=0; q<k; q++ ) applyA( s.rec_w[q], s.rec_aw[q], n );
+	for( int q=0; q<k; q++ ) for( int t=0; t<=q; t++ ) {
+		L[q*k+t] = L[t*k+q] = -product( s.rec_w[q], s.rec_aw[t], n );
+	}
+	if( ! cholesky(L,k) ) s.rec_k = 0;
+}
+
+// Refine W From The Snapshots Taken This Solve
+// Each Snapshot s = x - x0 Is a Partial Sum of a_i p_i, So It Leans Toward The Smooth Modes A^-1 Amplifies
+// With V = [ W S ], The Ritz Pairs of A On span V Solve ( V^T A V ) y = theta ( V^T V ) y. The Directions Are
+// A-Orthogonal To W And To Each Other, So V^T A V Is Block Diagonal And s_a^T A s_b Is The Running Sum of
+// a_i^2 p_i^T A p_i Up To The Earlier Snapshot. Only V^T V Costs Passes
+// The RECYCLE_K Pairs With theta Nearest Zero ( The Smoothest Modes ) Become The New W
+template <class T> static void harvestRecycle( solver::Plan *plan, int m, int n ) {
+	Scratch<T> &s = scratch<T>(plan);
+	int k = s.rec_k;
+	int v = k+m;
+	if( m == 0 ) return;
+	Grid2DT<T> V[RECYCLE_MAX];
+	for( int q=0; q<k; q++ ) V[q] = s.rec_w[q];
+	for( int q=0; q<m; q++ ) V[k+q] = s.rec_s[q];
+	
+	// F = V^T A V, G = V^T V
+	double F[RECYCLE_MAX*RECYCLE_MAX];
+	double G[RECYCLE_MAX*RECYCLE_MAX];
+	for( int i=0; i<v; i++ ) for( int j=0; j<v; j++ ) F[i*v+j] = 0.0;
+	for( int i=0; i<k; i++ ) for( int j=0; j<k; j++ ) F[i*v+j] = product( s.rec_w[i], s.rec_aw[j], n );
+	for( int a=0; a<m; a++ ) for( int c=0; c<m; c++ ) F[(k+a)*v+k+c] = max(s.rec_sAs[a],s.rec_sAs[c]);
+	for( int i=0; i<v; i++ ) for( int j=0; j<=i; j++ ) G[i*v+j] = G[j*v+i] = product( V[i], V[j], n );
+	
+	// C = L^-1 F L^-T With G = L L^T, Then C z = theta z And y = L^-T z
+	if( ! cholesky(G,v) ) return;
+	double C[RECYCLE_MAX*RECYCLE_MAX];
+	double Z[RECYCLE_MAX*RECYCLE_MAX];
+	for( int j=0; j<v; j++ ) {
+		for( int i=0; i<v; i++ ) {
+			double t = F[i*v+j];
+			for( int l=0; l<i; l++ ) t -= G[i*v+l]*C[l*v+j];
+			C[i*v+j] = t/G[i*v+i];
+		}
+	}
+	for( int i=0; i<v; i++ ) {
+		for( int j=0; j<v; j++ ) {
+			double t = C[i*v+j];
+			for( int l=0; l<j; l++ ) t -= G[j*v+l]*Z[i*v+l];
+			Z[i*v+j] = t/G[j*v+j];
+		}
+	}
+	for( int i=0; i<v; i++ ) for( int j=0; j<v; j++ ) C[i*v+j] = Z[i*v+j];
+	jacobiEigen( C, Z, v );
+	
+	// A Is Negative Definite Off The Constants, So The Smoothest Modes Have The Largest theta
+	int order[RECYCLE_MAX];
+	for( int i=0; i<v; i++ ) order[i] = i;
+	for( int i=0; i<v; i++ ) for( int j=i+1; j<v; j++ ) {
+		if( C[order[j]*v+order[j]] > C[order[i]*v+order[i]] ) { int t = order[i]; order[i] = order[j]; order[j] = t; }
+	}
+	int keep = min(RECYCLE_K,v);
+	double Y[RECYCLE_MAX*RECYCLE_K];
+	for( int c=0; c<keep; c++ ) {
+		for( int i=v-1; i>=0; i-- ) {
+			double t = Z[i*v+order[c]];
+			for( int l=i+1; l<v; l++ ) t -= G[l*v+i]*Y[l*RECYCLE_K+c];
+			Y[i*RECYCLE_K+c] = t/G[i*v+i];
+		}
+	}
+	
+	// New W = V Y, Built In The A W Buffers ( Rebuilt Next ), Then The Two Swap
+	Grid2DT<T> *out = s.rec_aw;
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) {
+		for( int c=0; c<keep; c++ ) {
+			T *o = out[c][i];
+			for( int j=0; j<n; j++ ) o[j] = 0;
+			for( int l=0; l<v; l++ ) {
+				T y = Y[l*RECYCLE_K+c];
+				const T *in = V[l][i];
+				for( int j=0; j<n; j++ ) o[j] += y*in[j];
+			}
+		}
+	}
+	s.rec_aw = s.rec_w;
+	s.rec_w = out;
+	s.rec_k = keep;
+	
+	// The Kernels Always Walk RECYCLE_K Vectors, Unused Ones Must Be Zero
+	for( int q=keep; q<RECYCLE_K; q++ ) {
+		clear( s.rec_w[q], n );
+		clear( s.rec_aw[q], n );
+	}
+	factorRecycle<T>(plan,n);
+}
+
+// Deflated Conjugate Gradient ( Plain CG Until The First Solve Leaves a Basis )
+template <class T> static void deflatedCG( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Scratch<T> &s = scratch<T>(plan);
+	if( ! s.rec_w ) {
+		// Only Carved For real Grids
+		conjGrad(plan,x,b,n);
+		return;
+	}
+	Grid2DT<T> r = s.r;
+	Grid2DT<T> p = s.p;
+	Grid2DT<T> Ap = s.Ap;
+	int k = s.rec_k;
+	double dots[RECYCLE_K] = { 0.0 };
+	double mu[RECYCLE_K] = { 0.0 };
+	
+	// r = b-Ax, Then x = x + W E^-1 W^T r So r Has No W Part ( r = r - AW E^-1 W^T r )
+	residual( x, b, r, n );
+	project( r, n );
+	if( k ) {
+		for( int q=0; q<k; q++ ) dots[q] = product( s.rec_w[q], r, n );
+		deflateSolve( s.rec_L, dots, mu, k );
+		for( int q=0; q<k; q++ ) {
+			op( x, s.rec_w[q], x, mu[q], n );
+			op( r, s.rec_aw[q], r, -mu[q], n );
+		}
+	}
+	
+	// p = r - W E^-1 (AW)^T r
+	double rr1 = product( r, r, n );
+	for( int q=0; q<k; q++ ) dots[q] = product( s.rec_aw[q], r, n );
+	if( k ) {
+		deflateSolve( s.rec_L, dots, mu, k );
+		deflateDirection( r, p, 0.0, s.rec_w, mu, k, n );
+	} else {
+		copy( p, r, n );
+	}
+	int harvested = 0;
+	int slot = 0;
+	double energy = 0.0;						// Running Sum of a^2 p^T A p
+	copy( s.z, x, n );							// x0 For The Snapshots
+	if( ! finished(plan,sqrt(rr1)/(n*n)) ) {
+		double mean = 0.0;
+		for(;;) {
+			double pAp = applyA( p, Ap, n );	// Ap, p^T * Ap
+			if( ! pAp ) break;
+			double a = rr1/pAp;
+			double rr2 = k ? deflateUpdate( x, r, p, Ap, a, mean, s.rec_aw, dots, n ) : update( x, r, p, Ap, a, mean, n );
+			plan->stats.iterations ++;
+			energy += a*a*pAp;
+			if( plan->stats.iterations % s.rec_stride == 0 ) {
+				copy( s.rec_s[slot], x, n );
+				s.rec_sAs[slot] = energy;
+				slot = (slot+1)%RECYCLE_M;
+				harvested = min(harvested+1,RECYCLE_M);
+			}
+			if( finished(plan,sqrt(rr2)/(n*n)) ) break;
+			if( k ) {
+				deflateSolve( s.rec_L, dots, mu, k );
+				deflateDirection( r, p, rr2/rr1, s.rec_w, mu, k, n );	// p = r + b*p - W mu
+			} else {
+				op( r, p, p, rr2/rr1, n );								// p = r + b*p
+			}
+			rr1 = rr2;
+		}
+		plan->stats.residual = residualNorm( plan, x, b, n );
+	}
+	
+	// Always Keep The Final x, Then Make The Snapshots Relative To x0
+	if( plan->stats.iterations % s.rec_stride ) {
+		copy( s.rec_s[slot], x, n );
+		s.rec_sAs[slot] = energy;
+		harvested = min(harvested+1,RECYCLE_M);
+	}
+	for( int q=0; q<harvested; q++ ) op( s.rec_s[q], s.z, s.rec_s[q], -1.0, n );
+	harvestRecycle<T>( plan, harvested, n );
+	s.rec_stride = max(1,plan->stats.iterations/RECYCLE_M);
+}
+
+// dst <= src ( Precision Conversion )
+template <class D, class S> static void convert( Grid2DT<D> dst, Grid2DT<S> src, int n ) {
+	for( int i=0; i<n; i++ ) {
+		for( int j=0; j<n; j++ ) {
+			dst[i][j] = src[i][j];
+		}
+	}
+}
+
+// x = x + e ( Precision Conversion )
+template <class D, class S> static void correct( Grid2DT<D> x, Grid2DT<S> e, int n ) {
+	for( int i=0; i<n; i++ ) {
+		for( int j=0; j<n; j++ ) {
+			x[i][j] += e[i][j];
+		}
+	}
+}
+
+// Mixed Precision Multigrid With Iterative Refinement
+// Residual b-Ax Is Computed In double, Correction Ae = r Is Solved In float
+// The float Cycles Run The float simd Rows, Twice The Lanes And Half The Bytes of a double Cycle
+template <class T> static void mixedRefine( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Grid2DT<double> xd = plan->ref_x;
+	Grid2DT<double> bd = plan->ref_b;
+	Grid2DT<double> rd = plan->ref_r;
+	Grid2DT<float> rf = scratch<float>(plan).r;
+	Grid2DT<float> ef = scratch<float>(plan).p;
+	
+	convert(xd,x,n);
+	convert(bd,b,n);
+	for(;;) {
+		residual( xd, bd, rd, n );					// r = b-Ax ( double )
+		if( finished(plan,norm(rd,n)) ) break;
+		convert(rf,rd,n);
+		clear(ef,n);
+		mgv(plan,ef,rf,n);							// Ae = r ( float )
+		smooth(plan,ef,rf,n,8);
+		correct(xd,ef,n);							// x = x + e ( double )
+		plan->stats.iterations ++;
+	}
+	convert(x,xd,n);
+}
+
+// Gauss-Seidel Checking The Residual Every GS_CHECK Sweeps
+// blocked Runs Those Sweeps As One Wavefront Pass ( Same Result, One Trip Through Memory ) Unless The Grid Fits In Cache
+#define GS_CHECK		10
+#define GS_SWEEPS		6		// Red And Black: x 2, b 1 Each
+#define GS_WAVE_SWEEPS	3		// x 2, b 1 For All GS_CHECK Sweeps
+#define GS_CHECK_SWEEPS	4		// Residual Check: r 3, norm 1
+
+// Below This Many Bytes of x And b The Plain Sweeps Already Run From Cache ( About a Per-Core L2 )
+// And The Wavefront Only Adds Overhead. Break-Even Was Between 224 x 224 And 256 x 256 In double
+#define GS_WAVE_CACHE	(1<<20)
+static bool waveWorthIt( int n, size_t cell ) {
+	return (double)n*n*2*cell >= GS_WAVE_CACHE;
+}
+
+template <class T> static void gsSolve( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n, bool blocked=false ) {
+	blocked = blocked && waveWorthIt(n,sizeof(T));
+	if( finished(plan,residualNorm(plan,x,b,n)) ) return;
+	for(;;) {
+		int t = min(GS_CHECK,plan->tol.maxIter-plan->stats.iterations);
+		if( blocked ) gaussseidelWave(x,b,n,t);
+		else gaussseidel(x,b,n,t);
+		plan->stats.iterations += t;
+		if( finished(plan,residualNorm(plan,x,b,n)) ) break;
+	}
+}
+
+// V-Cycles ( Each Followed By 8 Sweeps ) Until Converged
+template <class T> static void mgSolve( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	if( finished(plan,residualNorm(plan,x,b,n)) ) return;
+	for(;;) {
+		mgv(plan,x,b,n);
+		smooth(plan,x,b,n,8);
+		plan->stats.iterations ++;
+		if( finished(plan,residualNorm(plan,x,b,n)) ) break;
+	}
+}
+
+// One Full Multigrid Pass, Then Cycles of The Chosen Type Until Converged
+template <class T> static void fmgSolve( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	if( finished(plan,residualNorm(plan,x,b,n)) ) return;
+	fullMultigrid(plan,x,b,n);
+	plan->stats.iterations ++;
+	while( ! finished(plan,residualNorm(plan,x,b,n)) ) {
+		cycle(plan,x,b,0,plan->cycle);
+		plan->stats.iterations ++;
+	}
+}
+
+// In Place Radix-2 FFT of n Interleaved Complex Values ( Unscaled )
+template <class T> static void fft( solver::Plan *plan, T *a, int n, bool inverse ) {
+	for( int i=1, j=0; i<n; i++ ) {
+		int bit = n>>1;
+		for( ; j&bit; bit>>=1 ) j ^= bit;
+		j ^= bit;
+		if( i < j ) {
+			T re = a[2*i]; a[2*i] = a[2*j]; a[2*j] = re;
+			T im = a[2*i+1]; a[2*i+1] = a[2*j+1]; a[2*j+1] = im;
+		}
+	}
+	T sign = inverse ? -1 : 1;
+	for( int len=2; len<=n; len<<=1 ) {
+		int step = n/len;
+		for( int i=0; i<n; i+=len ) {
+			for( int k=0; k<len/2; k++ ) {
+				T wr = plan->fft_twiddle[2*k*step];
+				T wi = sign*plan->fft_twiddle[2*k*step+1];
+				T *u = a+2*(i+k);
+				T *v = a+2*(i+k+len/2);
+				T vr = v[0]*wr-v[1]*wi;
+				T vi = v[0]*wi+v[1]*wr;
+				v[0] = u[0]-vr;
+				v[1] = u[1]-vi;
+				u[0] += vr;
+				u[1] += vi;
+			}
+		}
+	}
+}
+
+// In Place Length n DFT of Interleaved Complex Values ( Unscaled )
+// The Radix-2 FFT When n Is a Power of Two, Else Bluestein: The DFT As a Chirp Convolution
+// Done With Two FFTs of Length fft_n >= 2n-1, So Any n Stays O(n log n). a Holds 2 fft_n Values
+template <class T> static void dft( solver::Plan *plan, T *a, int n, bool inverse ) {
+	if( plan->dct_fast ) {
+		fft(plan,a,n,inverse);
+		return;
+	}
+	int m = plan->fft_n;
+	const double *c = plan->chirp;
+	const double *B = plan->chirp_fft;
+	
+	// The Inverse Is The Conjugate of The Forward DFT of The Conjugate
+	T sign = inverse ? -1 : 1;
+	for( int k=0; k<n; k++ ) {
+		T re = a[2*k];
+		T im = sign*a[2*k+1];
+		a[2*k] = re*c[2*k]-im*c[2*k+1];
+		a[2*k+1] = re*c[2*k+1]+im*c[2*k];
+	}
+	for( int k=2*n; k<2*m; k++ ) a[k] = 0;
+	fft(plan,a,m,false);
+	for( int k=0; k<m; k++ ) {
+		T re = a[2*k];
+		T im = a[2*k+1];
+		a[2*k] = re*B[2*k]-im*B[2*k+1];
+		a[2*k+1] = re*B[2*k+1]+im*B[2*k];
+	}
+	fft(plan,a,m,true);
+	T scale = 1.0/m;
+	for( int k=0; k<n; k++ ) {
+		T re = a[2*k]*scale;
+		T im = a[2*k+1]*scale;
+		a[2*k] = re*c[2*k]-im*c[2*k+1];
+		a[2*k+1] = sign*(re*c[2*k+1]+im*c[2*k]);
+	}
+}
+
+// x <= DCT-II of x, X[k] = sum x[m] cos(pi k(2m+1)/(2n))
+// A Length n Complex DFT of The Even/Odd Reordered Row ( Makhoul )
+template <class T> static void dctRow( solver::Plan *plan, T *x, T *work, int n ) {
+	for( int m=0; m<(n+1)/2; m++ ) work[2*m] = x[2*m];
+	for( int m=0; m<n/2; m++ ) work[2*(n-1-m)] = x[2*m+1];
+	for( int m=0; m<n; m++ ) work[2*m+1] = 0;
+	dft(plan,work,n,false);
+	for( int k=0; k<n; k++ ) {
+		x[k] = plan->dct_shift[2*k]*work[2*k]+plan->dct_shift[2*k+1]*work[2*k+1];
+	}
+}
+
+// x <= Inverse of dctRow ( DCT-III Scaled By 1/n )
+template <class T> static void idctRow( solver::Plan *plan, T *x, T *work, int n ) {
+	for( int k=0; k<n; k++ ) {
+		T c = plan->dct_shift[2*k];
+		T s = plan->dct_shift[2*k+1];
+		T Xk = x[k];
+		T Xnk = k ? x[n-k] : 0;
+		work[2*k] = c*Xk+s*Xnk;
+		work[2*k+1] = s*Xk-c*Xnk;
+	}
+	dft(plan,work,n,true);
+	T scale = 1.0/n;
+	for( int m=0; m<(n+1)/2; m++ ) x[2*m] = work[2*m]*scale;
+	for( int m=0; m<n/2; m++ ) x[2*m+1] = work[2*(n-1-m)]*scale;
+}
+
+// dst = src^T ( n x n, In 32 x 32 Blocks )
+#define TRANSPOSE_BLOCK	32
+template <class T> static void transpose( Grid2DT<T> dst, Grid2DT<T> src, int n ) {
+	OPENMP_FOR
+	for( int bi=0; bi<n; bi+=TRANSPOSE_BLOCK ) {
+		for( int bj=0; bj<n; bj+=TRANSPOSE_BLOCK ) {
+			for( int i=bi; i<min(n,bi+TRANSPOSE_BLOCK); i++ ) {
+				for( int j=bj; j<min(n,bj+TRANSPOSE_BLOCK); j++ ) {
+					dst[j][i] = src[i][j];
+				}
+			}
+		}
+	}
+}
+
+// Direct Solve With The 2D DCT, Which Diagonalizes The Neumann Laplacian of applyA
+// ( Cell Centered, Clamped Halo ). O(n^2 log n) For Any n, No Iterations
+// The Constant Mode Is Set To Zero, So x Is The Zero Mean Solution And The Initial x Is Ignored
+template <class T> static void spectralSolve( solver::Plan *plan, Grid2DT<T> x, Grid2DT<T> b, int n ) {
+	Grid2DT<T> t = scratch<T>(plan).p;
+	Grid2DT<T> tt = scratch<T>(plan).Ap;
+	Grid2DT<T> work = scratch<T>(plan).dct_work;
+	
+	// Transform Along j, Then Along i ( As Rows of The Transpose )
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) {
+		for( int j=0; j<n; j++ ) t[i][j] = b[i][j];
+		dctRow(plan,t[i],work[i],n);
+	}
+	transpose(tt,t,n);
+	OPENMP_FOR
+	for( int l=0; l<n; l++ ) {
+		T *row = tt[l];
+		dctRow(plan,row,work[l],n);
+		
+		// Divide By The Eigenvalues of A
+		for( int k=0; k<n; k++ ) {
+			double lambda = (plan->dct_lambda[k]+plan->dct_lambda[l])*n*n;
+			row[k] = lambda ? row[k]/lambda : 0;
+		}
+		idctRow(plan,row,work[l],n);
+	}
+	transpose(t,tt,n);
+	OPENMP_FOR
+	for( int i=0; i<n; i++ ) {
+		idctRow(plan,t[i],work[i],n);
+		for( int j=0; j<n; j++ ) x[i][j] = t[i][j];
+	}
+}
+
+// FFT Length of The DCT Solver: n When a Power of Two, Else The Smallest Power of Two >= 2n-1
+static int fftLength( int n ) {
+	if( ! (n&(n-1)) ) return n;
+	int m = 1;
+	while( m < 2*n-1 ) m <<= 1;
+	return m;
+}
+
+// Build The Transform Tables of an n x n Grid
+static void factorSpectral( solver::Plan *plan, int n ) {
+	int m = fftLength(n);
+	plan->dct_fast = m == n;
+	plan->fft_n = m;
+	for( int k=0; k<n; k++ ) {
+		plan->dct_lambda[k] = 2.0*cos(DCT_PI*k/n)-2.0;
+		plan->dct_shift[2*k] = cos(DCT_PI*k/(2.0*n));
+		plan->dct_shift[2*k+1] = sin(DCT_PI*k/(2.0*n));
+	}
+	for( int k=0; k<m/2; k++ ) {
+		plan->fft_twiddle[2*k] = cos(2.0*DCT_PI*k/m);
+		plan->fft_twiddle[2*k+1] = -sin(2.0*DCT_PI*k/m);
+	}
+	if( plan->dct_fast ) return;
+	
+	// Chirp e^(-pi i k^2/n), With k^2 Reduced Mod 2n To Keep The Angle Exact
+	double *B = plan->chirp_fft;
+	for( int k=0; k<2*m; k++ ) B[k] = 0.0;
+	for( int k=0; k<n; k++ ) {
+		double angle = DCT_PI*(double)(((long long)k*k)%(2*n))/n;
+		plan->chirp[2*k] = cos(angle);
+		plan->chirp[2*k+1] = -sin(angle);
+		B[2*k] = cos(angle);
+		B[2*k+1] = sin(angle);
+		if( k ) {
+			B[2*(m-k)] = cos(angle);
+			B[2*(m-k)+1] = sin(angle);
+		}
+	}
+	fft(plan,B,m,false);
+}
+
+// Whether The Full Multigrid Hierarchy Ends At Size n
+static bool coarsest( int n ) {
+	return n <= COARSE_MIN || ( n%2 && n <= COARSE_ODD );
+}
+
+// Number of Full Multigrid Levels of an n x n Grid
+static int coarseLevels( int n ) {
+	int levels = 1;
+	for( int ln=n; ! coarsest(ln); ln=coarsen(ln) ) levels ++;
+	return levels;
+}
+
+// Buffers Beyond The Residual r That Each Method Touches
+#define USE_KRYLOV		1		// p And Ap ( Transpose Buffers In The DCT Solver )
+#define USE_PRECOND		2		// z ( x0 of The Deflated CG Snapshots )
+#define USE_PIPELINE	4		// w[2]
+#define USE_MIC			8		// MIC(0) Factor
+#define USE_DCT			16		// Transform Tables And Rows
+#define USE_VCYCLE		32		// mgv Hierarchy
+#define USE_LEVELS		64		// Full Multigrid Levels And The Coarsest Factor
+#define USE_SMOOTHER	128		// Chebyshev Scratch ( Dropped Unless The Plan Smooths With It )
+#define USE_RECYCLE		256		// Deflated CG Basis
+#define USE_MIXED		512		// double Refinement Grids, The Rest Is Carved In float
+static const int method_uses[] = {
+	0,
+	USE_KRYLOV,
+	USE_VCYCLE | USE_SMOOTHER,
+	USE_MIXED | USE_KRYLOV | USE_VCYCLE | USE_SMOOTHER,
+	USE_LEVELS | USE_SMOOTHER,
+	USE_KRYLOV | USE_PRECOND | USE_LEVELS | USE_SMOOTHER,
+	USE_KRYLOV | USE_PRECOND | USE_MIC,
+	USE_KRYLOV | USE_DCT,
+	USE_KRYLOV | USE_PRECOND | USE_PIPELINE,
+	USE_KRYLOV | USE_PRECOND | USE_RECYCLE,
+	0
+};
+
+template <class T> static void bindScratch( solver::Plan *plan, Workspace &ws, int n, int uses ) {
+	Scratch<T> &s = scratch<T>(plan);
+	s.r = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+	if( uses & USE_KRYLOV ) {
+		s.p = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+		s.Ap = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+	}
+	if( uses & USE_PRECOND ) s.z = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+	if( uses & USE_PIPELINE ) {
+		s.w[0] = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+		s.w[1] = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+	}
+	if( uses & USE_MIC ) {
+		s.mic = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+		if( ws.slab ) factorMIC(s.mic,n);
+	}
+	if( uses & USE_DCT ) s.dct_work = carve2DT<T>(ws,n,2*fftLength(n));
+	
+	// One Level Per V-Cycle Recursion ( See mgv ), Down To 2 x 2
+	int depth = 1;
+	for( int ln=n; ln>2; ln=coarsen(ln) ) depth ++;
+	s.top_n = n;
+	if( uses & USE_VCYCLE ) {
+		s.fine_r = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*depth);
+		s.fine_e = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*depth);
+		s.coarse_r = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*depth);
+		s.coarse_e = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*depth);
+		for( int recr=0, ln=n; recr<depth; recr++, ln=coarsen(ln) ) {
+			int cn = coarsen(ln);
+			Grid2DT<T> fr = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			Grid2DT<T> fe = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			Grid2DT<T> cr = carve2DT<T>(ws,cn,cn+1,SOLVER_HALO);
+			Grid2DT<T> ce = carve2DT<T>(ws,cn,cn+1,SOLVER_HALO);
+			if( ! ws.slab ) continue;
+			s.fine_r[recr] = fr;
+			s.fine_e[recr] = fe;
+			s.coarse_r[recr] = cr;
+			s.coarse_e[recr] = ce;
+		}
+	}
+	
+	// Full Multigrid Levels Halve Down To COARSE_MIN ( Or An Odd Size Up To COARSE_ODD )
+	if( uses & USE_LEVELS ) {
+		s.levels = coarseLevels(n);
+		s.level_n = (int *)carve(ws,sizeof(int)*s.levels);
+		s.level_x = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*s.levels);
+		s.level_b = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*s.levels);
+		s.level_r = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*s.levels);
+		for( int l=0, ln=n; l<s.levels; l++, ln=coarsen(ln) ) {
+			Grid2DT<T> x = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			Grid2DT<T> b = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			Grid2DT<T> r = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			if( ! ws.slab ) continue;
+			s.level_n[l] = ln;
+			s.level_x[l] = x;
+			s.level_b[l] = b;
+			s.level_r[l] = r;
+		}
+	}
+	
+	// Deflated CG Basis And Snapshots ( Kept Across Solves With This Plan )
+	s.rec_w = NULL;
+	s.rec_k = 0;
+	s.rec_stride = max(1,n/4);
+	if( uses & USE_RECYCLE ) {
+		s.rec_w = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*RECYCLE_K);
+		s.rec_aw = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*RECYCLE_K);
+		s.rec_s = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*RECYCLE_M);
+		s.rec_sAs = (double *)carve(ws,sizeof(double)*RECYCLE_M);
+		s.rec_L = (double *)carve(ws,sizeof(double)*RECYCLE_K*RECYCLE_K);
+		for( int q=0; q<RECYCLE_M; q++ ) {
+			Grid2DT<T> g = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+			if( ws.slab ) s.rec_s[q] = g;
+		}
+		for( int q=0; q<RECYCLE_K; q++ ) {
+			Grid2DT<T> w = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+			Grid2DT<T> aw = carve2DT<T>(ws,n,n+1,SOLVER_HALO);
+			if( ! ws.slab ) continue;
+			s.rec_w[q] = w;
+			s.rec_aw[q] = aw;
+		}
+	}
+	
+	// Chebyshev Smoother Scratch, One More Level Than mgv Has ( Its 1 x 1 Coarse Grid )
+	if( uses & USE_SMOOTHER ) {
+		s.cheb_r = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*(depth+1));
+		s.cheb_d = (Grid2DT<T> *)carve(ws,sizeof(Grid2DT<T>)*(depth+1));
+		s.cheb_max = (double *)carve(ws,sizeof(double)*(depth+1));
+		for( int l=0, ln=n; l<=depth; l++, ln=coarsen(ln) ) {
+			Grid2DT<T> r = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			Grid2DT<T> d = carve2DT<T>(ws,ln,ln+1,SOLVER_HALO);
+			if( ! ws.slab ) continue;
+			s.cheb_r[l] = r;
+			s.cheb_d[l] = d;
+			s.cheb_max[l] = CHEB_SAFETY*largestEigen(r,d,ln);
+		}
+	}
+}
+
+// Carve The Buffers of a Plan ( Called Twice By allocWorkspace, See carve )
+static void bindPlan( Workspace &ws, void *data ) {
+	solver::Plan *plan = (solver::Plan *)data;
+	int n = plan->n;
+	int uses = method_uses[plan->method];
+	if( plan->smoother != SMOOTH_CHEBYSHEV ) uses &= ~USE_SMOOTHER;
+	
+	// Mixed Precision Solver Runs Its Inner Cycles In float, Checking Only In double
+	if( uses & USE_MIXED ) {
+		bindScratch<float>(plan,ws,n,uses);
+		if( sizeof(real) != sizeof(float) ) bindScratch<real>(plan,ws,n,0);
+		plan->ref_x = carve2DT<double>(ws,n,n+1,SOLVER_HALO);
+		plan->ref_b = carve2DT<double>(ws,n,n+1,SOLVER_HALO);
+		plan->ref_r = carve2DT<double>(ws,n,n+1,SOLVER_HALO);
+	} else {
+		bindScratch<real>(plan,ws,n,uses);
+	}
+	
+	// DCT Solver Tables
+	if( uses & USE_DCT ) {
+		plan->dct_lambda = (double *)carve(ws,sizeof(double)*n);
+		plan->dct_shift = (double *)carve(ws,sizeof(double)*2*n);
+		int m = fftLength(n);
+		plan->fft_twiddle = (double *)carve(ws,sizeof(double)*m);
+		if( m != n ) {
+			plan->chirp = (double *)carve(ws,sizeof(double)*2*n);
+			plan->chirp_fft = (double *)carve(ws,sizeof(double)*2*m);
+		}
+		if( ws.slab ) factorSpectral(plan,n);
+	}
+	
+	// Coarsest Full Multigrid Level
+	if( uses & USE_LEVELS ) {
+		int cn = n;
+		while( ! coarsest(cn) ) cn = coarsen(cn);
+		plan->coarse_L = (double *)carve(ws,sizeof(double)*cn*cn*cn*cn);
+		plan->coarse_y = (double *)carve(ws,sizeof(double)*cn*cn);
+		if( plan->coarse_L ) factorCoarse(plan->coarse_L,cn);
+	}
+}
+
+solver::Plan * solver::createPlan( int method, int n, const Tolerance &tol, int cycle, int smoother ) {
+	Plan *plan = new Plan();
+	plan->method = method;
+	plan->n = n;
+	plan->cycle = cycle;
+	plan->smoother = smoother;
+	plan->tol = tol;
+	allocWorkspace(plan->ws,bindPlan,plan);
+	return plan;
+}
+
+void solver::destroyPlan( Plan *plan ) {
+	if( ! plan ) return;
+	freeWorkspace(plan->ws);
+	delete plan;
+}
+
+void solver::setTolerance( Plan *plan, const Tolerance &tol ) {
+	plan->tol = tol;
+}
+
+size_t solver::footprint( const Plan *plan ) {
+	return plan->ws.capacity;
+}
+
+double solver::bytesPerIteration( int method, int n, bool fused ) {
+	double check = GS_CHECK_SWEEPS/(double)GS_CHECK;
+	if( method == 10 && ! waveWorthIt(n,sizeof(real)) ) fused = false;
+	if( method == 0 || (method == 10 && ! fused) ) return (GS_SWEEPS+check)*n*n*sizeof(real);
+	if( method == 10 ) return (GS_WAVE_SWEEPS/(double)GS_CHECK+check)*n*n*sizeof(real);
+	if( method == 8 ) return (CG_PIPELINED_SWEEPS+CG_REPLACE_SWEEPS/(double)CG_REPLACE)*n*n*sizeof(real);
+	if( method == 9 ) return (double)(CG_FUSED_SWEEPS+2*RECYCLE_K)*n*n*sizeof(real);
+	if( method != 1 ) return 0.0;
+	return (double)(fused ? CG_FUSED_SWEEPS : CG_UNFUSED_SWEEPS)*n*n*sizeof(real);
+}
+
+solver::Result solver::execute( Plan *plan, Grid2D x, Grid2D b ) {
+	int n = plan->n;
+	const Tolerance &tol = plan->tol;
+	Result &stats = plan->stats;
+	
+	plan->start_time = getMicroseconds();
+	stats.iterations = 0;
+	stats.residual = 0.0;
+	stats.converged = false;
+	stats.history = plan->history;
+	stats.count = 0;
+	
+	// Ax = b Only Has a Solution When b Sums To Zero ( Net Sources Break That )
+	project(b,n);
+	double bnorm = norm(b,n);
+	plan->target = max(tol.relative*bnorm,tol.absolute);
+	
+	switch(plan->method) {
 		case 0:
 			// Gaus-Seidel
-			gaussseidel(x,b,n,numiter);
+			gsSolve(plan,x,b,n);
 			break;
 		case 1:
 			// Conjugate Gradient Method
-			conjGrad(x,b,n);
+			conjGrad(plan,x,b,n);
 			break;
 		case 2:
 			// Multigrid Method
-			mgv(x,b,n);
-			smooth( x, b, n, 8 );
+			mgSolve(plan,x,b,n);
+			break;
+		case 3:
+			// Mixed Precision Multigrid Method
+			mixedRefine(plan,x,b,n);
+			break;
+		case 4:
+			// Full Multigrid Method
+			fmgSolve(plan,x,b,n);
+			break;
+		case 5:
+			// Multigrid Preconditioned Conjugate Gradient
+			pcg(plan,x,b,n,mgPrecond<real>);
+			break;
+		case 6:
+			// MIC(0) Preconditioned Conjugate Gradient
+			pcg(plan,x,b,n,micPrecond<real>);
+			break;
+		case 7:
+			// DCT Direct Solver
+			if( finished(plan,residualNorm(plan,x,b,n)) ) break;
+			spectralSolve(plan,x,b,n);
+			stats.iterations ++;
+			finished(plan,residualNorm(plan,x,b,n));
+			break;
+		case 8:
+			// Pipelined Conjugate Gradient
+			pipeCG(plan,x,b,n);
+			break;
+		case 9:
+			// Deflated Conjugate Gradient
+			deflatedCG(plan,x,b,n);
+			break;
+		case 10:
+			// Temporally Blocked Gauss-Seidel
+			gsSolve(plan,x,b,n,true);
 			break;
 	}
-	residual( x, b, r, n );
-	return sqrt(product( r, r, n ))/(n*n);
-}
\ No newline at end of file
+	stats.time = (getMicroseconds()-plan->start_time)/1000.0;
+	return stats;
+}
@@ -8,13 +8,90 @@
 // 0: Gauss-Seldel Method
 // 1: Conjugate Gradient Method
 // 2: Multigrid V-Cycle
+// 3: Mixed Precision Multigrid ( float V-Cycles, double Residual Refinement )
+// 4: Full Multigrid ( Full Weighting, Bilinear Prolongation, Exact Coarsest Solve )
+// 5: Multigrid Preconditioned Conjugate Gradient ( One V-Cycle Per Iteration )
+// 6: MIC(0) Preconditioned Conjugate Gradient ( Factored When The Plan Is Made )
+// 7: DCT Direct Solver ( Radix-2 FFT, Or Bluestein When n Is Not a Power of Two, Exact Up To Rounding )
+// 8: Pipelined Conjugate Gradient ( One Fused Pass And One Reduction Per Iteration )
+// 9: Deflated Conjugate Gradient ( Recycles Ritz Vectors From The Previous Solves of The Same Plan )
+// 10: Temporally Blocked Gauss-Seidel ( Same Sweeps As 0, Ten Per Wavefront Pass Over Memory )
+
+// Cycle ( Full Multigrid Only ):
+// 0: V-Cycle
+// 1: W-Cycle
+// 2: F-Cycle
+
+// Smoother ( Every Multigrid Solver ):
+// 0: Red-Black Gauss-Seidel
+// 1: Lexicographic Gauss-Seidel ( Single Threaded )
+// 2: Chebyshev Accelerated Jacobi ( Eigenvalue Bounds Estimated Per Level When The Plan Is Made )
+
+#include "utility.h"
 
 extern const char *solver_name[];
+extern const char *cycle_name[];
+extern const char *smoother_name[];
+
+// Ghost Cells Needed Around x ( 5-Point Laplacian )
+#define SOLVER_HALO		1
+
+#define CYCLE_V			0
+#define CYCLE_W			1
+#define CYCLE_F			2
+
+#define SMOOTH_RBGS		0
+#define SMOOTH_GS		1
+#define SMOOTH_CHEBYSHEV	2
 
 namespace solver {
-	// Solve Ax = b
-	// RETURN: Residual
+	// Memory Traffic of One Iteration In Bytes ( Gauss-Seidel 0 And 10, CG Solvers 1, 8 And 9, 0 Otherwise )
+	// fused=false Gives The Separate Kernel ( Or Unblocked ) Version For Comparison ( Same As fused For 0, 8, 9 And Cache Sized 10 )
+	double bytesPerIteration( int method, int n, bool fused=true );
+	
+	// When To Stop ( Whichever Comes First )
+	// Residuals Are |b-Ax| With The Constant Part Removed, Divided By n^2
+	struct Tolerance {
+		double relative;		// Residual <= relative * |b|
+		double absolute;		// Residual <= absolute
+		int maxIter;			// Iterations Used
+		double maxTime;			// Milliseconds Spent ( 0: No Limit ), Checked Between Iterations
+	};
+	
+	// What a Solve Did
+	// An Iteration Is a Sweep ( Gauss-Seidel ), a Step ( CG Solvers ), a Cycle ( Multigrid ),
+	// a Refinement ( Mixed Precision ) Or The Whole Solve ( DCT )
+	struct Result {
+		int iterations;
+		double residual;		// Final Residual
+		double time;			// Wall Time In Milliseconds
+		bool converged;			// Met a Tolerance ( Not Just Out of Budget )
+		const double *history;	// Residual Before The First Iteration And After Each Check
+		int count;				// Entries In history ( Valid Until The Plan's Next Solve )
+	};
+	
+	// A Method Set Up For One Grid Size: Its Scratch Grids, Multigrid Hierarchy And Preconditioner,
+	// Allocated Once And Reused By Every execute. Plans of Different Sizes Can Coexist
+	struct Plan;
+	
+	// Allocate Only What method Needs For an n x n Grid ( Factorizations Are Done Here Too )
+	// cycle Is CYCLE_V, CYCLE_W Or CYCLE_F ( Full Multigrid ), smoother Is SMOOTH_RBGS, SMOOTH_GS
+	// Or SMOOTH_CHEBYSHEV ( Every Multigrid Solver )
+	Plan * createPlan( int method, int n, const Tolerance &tol, int cycle=CYCLE_V, int smoother=SMOOTH_RBGS );
+	
+	// Free a Plan And Everything It Allocated ( NULL Is Ignored )
+	void destroyPlan( Plan *plan );
+	
+	// Change When The Plan's Solves Stop
+	void setTolerance( Plan *plan, const Tolerance &tol );
+	
+	// Bytes The Plan Allocated
+	size_t footprint( const Plan *plan );
+	
+	// Solve Ax = b Starting From x With The Plan's Method And Tolerance
 	
-	// NOTICE: A is a Nullspace Matrix
-	double solve( int method, int numiter, double **x, double **b, int n );
+	// NOTICE: A is a Nullspace Matrix, So The Mean of b Is Removed In Place First
+	// NOTICE: x Must Carry a Halo of SOLVER_HALO Cells
+	// NOTICE: Each Plan Keeps Its Own Bookkeeping, So Different Plans Can Execute On Different Threads
+	Result execute( Plan *plan, Grid2D x, Grid2D b );
 }
@@ -5,32 +5,181 @@
  */
 
 #include "utility.h"
+#include "simd.h"
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
-double ** alloc2D( int n ) {
-	double **ptr = new double *[n+1];
-	for( int i=0; i<n; i++ ) {
-		ptr[i] = new double[n+1];
-		for( int j=0; j<n+1; j++ ) ptr[i][j] = 0.0;
+unsigned long getMicroseconds() {
+#if defined(_WIN32)
+	LARGE_INTEGER nFreq, Time;
+	QueryPerformanceFrequency(&nFreq);
+	QueryPerformanceCounter(&Time);
+	return (double)Time.QuadPart / nFreq.QuadPart * 1000000;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec*1000000 + tv.tv_usec;
+#endif
+}
+
+void * alignedAlloc( size_t size ) {
+	void *ptr = NULL;
+#if defined(_WIN32)
+	ptr = _aligned_malloc(size,GRID_ALIGN);
+#else
+	if( posix_memalign(&ptr,GRID_ALIGN,size) ) ptr = NULL;
+#endif
+	if( ! ptr ) {
+		printf( "Failed to allocate %lu bytes\n", (unsigned long)size );
+		exit(1);
 	}
-	ptr[n] = NULL;
 	return ptr;
 }
 
-void free2D( double **ptr ) {
-	for( int i=0; ptr[i]; i++ ) delete [] ptr[i];
-	delete [] ptr;
+void alignedFree( void *ptr ) {
+#if defined(_WIN32)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+Grid2D alloc2D( int w, int h, int halo ) {
+	return alloc2DT<real>(w,h,halo);
+}
+
+Grid2D alloc2D( int n, int halo ) {
+	return alloc2D(n,n+1,halo);
+}
+
+Grid2D carve2D( Workspace &ws, int n, int halo ) {
+	return carve2DT<real>(ws,n,n+1,halo);
+}
+
+MACGrid allocMAC( int n, int halo ) {
+	MACGrid u;
+	u.n = n;
+	u.face[0] = alloc2D(n+1,n,halo);
+	u.face[1] = alloc2D(n,n+1,halo);
+	return u;
+}
+
+MACGrid carveMAC( Workspace &ws, int n, int halo ) {
+	MACGrid u;
+	u.n = n;
+	u.face[0] = carve2DT<real>(ws,n+1,n,halo);
+	u.face[1] = carve2DT<real>(ws,n,n+1,halo);
+	return u;
+}
+
+void freeMAC( MACGrid &u ) {
+	free2D(u.face[0]);
+	free2D(u.face[1]);
+}
+
+void allocWorkspace( Workspace &ws, void (*bind)( Workspace &ws ) ) {
+	// Measure
+	ws.slab = NULL;
+	ws.size = 0;
+	ws.capacity = 0;
+	bind(ws);
+	
+	// Allocate And Bind For Real
+	ws.capacity = ws.size;
+	ws.slab = (char *)alignedAlloc(ws.capacity);
+	ws.size = 0;
+	bind(ws);
+}
+
+void allocWorkspace( Workspace &ws, void (*bind)( Workspace &ws, void *data ), void *data ) {
+	// Measure
+	ws.slab = NULL;
+	ws.size = 0;
+	ws.capacity = 0;
+	bind(ws,data);
+	
+	// Allocate And Bind For Real
+	ws.capacity = ws.size;
+	ws.slab = (char *)alignedAlloc(ws.capacity);
+	ws.size = 0;
+	bind(ws,data);
+}
+
+void freeWorkspace( Workspace &ws ) {
+	alignedFree(ws.slab);
+	ws.slab = NULL;
+	ws.size = 0;
+	ws.capacity = 0;
+}
+
+void * carve( Workspace &ws, size_t size ) {
+	size = (size+GRID_ALIGN-1)/GRID_ALIGN*GRID_ALIGN;
+	char *ptr = NULL;
+	if( ws.slab ) {
+		if( ws.size+size > ws.capacity ) {
+			printf( "Workspace overflow ( %lu bytes requested, %lu left )\n",
+				   (unsigned long)size, (unsigned long)(ws.capacity-ws.size) );
+			exit(1);
+		}
+		ptr = ws.slab+ws.size;
+	}
+	ws.size += size;
+	return ptr;
 }
 
-void copy2D( double **dst, double **src, int n ) {
+void copy2D( Grid2D dst, Grid2D src, int n ) {
 	FOR_EVERY_CELL(n) {
 		dst[i][j] = src[i][j];
 	} END_FOR
 }
 
-void op2D( double **dst, double **src1, double **src2, double a, double b, int n ) {
-	FOR_EVERY_CELL(n) {
-		dst[i][j] = a*src1[i][j]+b*src2[i][j];
+void op2D( Grid2D dst, Grid2D src1, Grid2D src2, double a, double b, int n ) {
+	real ra = a;
+	real rb = b;
+	for( int i=0; i<n; i++ ) simd::kernels.combine( dst[i], src1[i], src2[i], ra, rb, n );
+}
+
+void copyMAC( MACGrid dst, MACGrid src ) {
+	FOR_EVERY_X_FLOW(dst.n) {
+		dst[0][i][j] = src[0][i][j];
 	} END_FOR
+	FOR_EVERY_Y_FLOW(dst.n) {
+		dst[1][i][j] = src[1][i][j];
+	} END_FOR
+}
+
+void opMAC( MACGrid dst, MACGrid src1, MACGrid src2, double a, double b ) {
+	real ra = a;
+	real rb = b;
+	FOR_EVERY_X_FLOW(dst.n) {
+		dst[0][i][j] = ra*src1[0][i][j]+rb*src2[0][i][j];
+	} END_FOR
+	FOR_EVERY_Y_FLOW(dst.n) {
+		dst[1][i][j] = ra*src1[1][i][j]+rb*src2[1][i][j];
+	} END_FOR
+}
+
+// Plain Row Loops So The Compiler Vectorizes The Conversion
+void pack16( Grid2D16 dst, Grid2D src, int w, int h ) {
+	OPENMP_FOR
+	for( int i=0; i<w; i++ ) {
+		fixed16 *out = dst[i];
+		const real *in = src[i];
+		for( int j=0; j<h; j++ ) out[j] = toFixed16(in[j]);
+	}
+}
+
+void unpack16( Grid2D dst, Grid2D16 src, int w, int h ) {
+	OPENMP_FOR
+	for( int i=0; i<w; i++ ) {
+		real *out = dst[i];
+		const fixed16 *in = src[i];
+		for( int j=0; j<h; j++ ) out[j] = fromFixed16(in[j]);
+	}
 }
@@ -4,12 +4,22 @@
  *
  */
 
+#ifndef _UTILITY_H
+#define _UTILITY_H
+
+// Include Before min/max Definition ( <cmath> Undefines Them )
+#include <math.h>
+#include <stddef.h>
+
 #define max(i,j) (i>j?i:j)
 #define min(i,j) (i>j?j:i)
 
-#define FOR_EVERY_X_FLOW(N)	for( int xn=0; xn<(N+1)*N; xn++ ) { int i=xn%(N+1); int j=xn/(N+1);
-#define FOR_EVERY_Y_FLOW(N)	for( int yn=0; yn<(N+1)*N; yn++ ) { int i=yn%N; int j=yn/N;
-#define FOR_EVERY_CELL(N)	for( int ci=0; ci<N*N; ci++ ) { int i=ci%N; int j=ci/N;
+// Walk a W x H Range In Storage Order ( j Is Contiguous, So It Runs Innermost )
+// OPENMP_FOR In Front Partitions The Rows
+#define FOR_EVERY_RANGE(W,H)	for( int i=0; i<(W); i++ ) for( int j=0; j<(H); j++ ) {
+#define FOR_EVERY_X_FLOW(N)	FOR_EVERY_RANGE((N)+1,N)
+#define FOR_EVERY_Y_FLOW(N)	FOR_EVERY_RANGE(N,(N)+1)
+#define FOR_EVERY_CELL(N)	FOR_EVERY_RANGE(N,N)
 #define END_FOR }
 
 #ifdef _OPENMP
@@ -19,15 +29,247 @@
 #define OPENMP_BEGIN	_Pragma("omp parallel" ) {
 #define OPENMP_END		}
 #define OPENMP_FOR_P	_Pragma("omp for" )
+#define OPENMP_PRAGMA(x)	_Pragma(#x)
+#define OPENMP_FOR_SUM(...)	OPENMP_PRAGMA(omp parallel for reduction(+:__VA_ARGS__))
+#define OPENMP_FOR_P_SUM(...)	OPENMP_PRAGMA(omp for reduction(+:__VA_ARGS__))
+#define OPENMP_CRITICAL	_Pragma("omp critical" )
 #else
 #define OPENMP_FOR
 #define OPENMP_SECTION
 #define OPENMP_BEGIN
 #define OPENMP_END
 #define OPENMP_FOR_P
+#define OPENMP_FOR_SUM(...)
+#define OPENMP_FOR_P_SUM(...)
+#define OPENMP_CRITICAL
+#endif
+
+// Scalar Type of The Simulation ( make FLOAT=1 For a Single Precision Build )
+#ifdef USE_FLOAT
+typedef float real;
+#else
+typedef double real;
 #endif
 
-double **alloc2D( int n );
-void free2D( double **ptr );
-void copy2D( double **dst, double **src, int n );
-void op2D( double **dst, double **src1, double **src2, double a, double b, int n ); // dst = a*src1 + b*src2
\ No newline at end of file
+// Wall Clock
+unsigned long getMicroseconds();
+
+// Alignment of Every Grid Row ( One Cache Line )
+#define GRID_ALIGN		64
+
+void * alignedAlloc( size_t size );
+void alignedFree( void *ptr );
+
+// Contiguous 2D Field
+// Access Bracket ptr[X][Y] ( Y Is Contiguous In Memory )
+// Each Row Starts On a GRID_ALIGN Boundary, stride Is The Row Pitch In Elements
+// A Halo of Ghost Cells Surrounds The Grid, So ptr[-halo..w+halo-1][-halo..h+halo-1] Is Valid
+// Copying a Grid2D Copies The Handle, Not The Data ( Just Like double ** Did )
+template <class T> struct Grid2DT {
+	T *ptr;			// Points To Cell (0,0)
+	int w;			// Number of Rows ( X )
+	int h;			// Number of Columns ( Y )
+	int halo;		// Ghost Cells On Each Side
+	int stride;		// Row Pitch ( >= h+2*halo )
+	inline T *operator[]( int i ) const { return ptr+(ptrdiff_t)i*stride; }
+	inline T operator()( int i, int j ) const { return ptr[(ptrdiff_t)i*stride+j]; }
+};
+typedef Grid2DT<real> Grid2D;
+
+// Round Up To a Multiple of GRID_ALIGN Bytes ( In Elements )
+template <class T> int pitch2D( int h ) {
+	const int align = GRID_ALIGN/sizeof(T);
+	return (h+align-1)/align*align;
+}
+
+// Set Up The Shape of a Grid, RETURN: Its Footprint In Elements
+// Interior Column 0 Is Kept Aligned By Padding The Leading Halo To GRID_ALIGN
+template <class T> size_t shape2D( Grid2DT<T> &grid, int w, int h, int halo ) {
+	grid.w = w;
+	grid.h = h;
+	grid.halo = halo;
+	grid.stride = pitch2D<T>(pitch2D<T>(halo)+h+halo);
+	return (size_t)(w+2*halo)*grid.stride;
+}
+
+// Point a Shaped Grid At Its ( Cleared ) Memory
+template <class T> void attach2D( Grid2DT<T> &grid, T *base ) {
+	size_t size = (size_t)(grid.w+2*grid.halo)*grid.stride;
+	for( size_t n=0; n<size; n++ ) base[n] = 0;
+	grid.ptr = base+(ptrdiff_t)grid.halo*grid.stride+pitch2D<T>(grid.halo);
+}
+
+// w x h Cleared Grid
+template <class T> Grid2DT<T> alloc2DT( int w, int h, int halo=0 ) {
+	Grid2DT<T> grid;
+	size_t size = shape2D(grid,w,h,halo);
+	attach2D(grid,(T *)alignedAlloc(sizeof(T)*size));
+	return grid;
+}
+
+template <class T> void free2D( Grid2DT<T> &grid ) {
+	alignedFree(grid.ptr-(ptrdiff_t)grid.halo*grid.stride-pitch2D<T>(grid.halo));
+	grid.ptr = NULL;
+}
+
+// Halo Fill Modes
+#define HALO_CLAMP		0	// Ghost Cells Repeat The Nearest Edge Value
+#define HALO_ZERO		1	// Ghost Cells Are Zero
+
+// Fill The Halo Around The Logical w x h Region ( Once Per Step, Not Per Fetch )
+template <class T> void fillHalo( Grid2DT<T> grid, int w, int h, int mode ) {
+	const int H = grid.halo;
+	OPENMP_FOR
+	for( int i=0; i<w; i++ ) {
+		T *row = grid[i];
+		T lo = mode == HALO_CLAMP ? row[0] : 0;
+		T hi = mode == HALO_CLAMP ? row[h-1] : 0;
+		for( int k=1; k<=H; k++ ) {
+			row[-k] = lo;
+			row[h-1+k] = hi;
+		}
+	}
+	for( int k=1; k<=H; k++ ) {
+		T *lo = grid[-k];
+		T *hi = grid[w-1+k];
+		const T *first = grid[0];
+		const T *last = grid[w-1];
+		for( int j=-H; j<h+H; j++ ) {
+			lo[j] = mode == HALO_CLAMP ? first[j] : 0;
+			hi[j] = mode == HALO_CLAMP ? last[j] : 0;
+		}
+	}
+}
+
+// Scratch Memory Arena
+// Grids Are Carved Out of One Slab With a Bump Pointer. allocWorkspace Runs
+// The Binding Function Twice: First With No Slab To Measure, Then For Real
+struct Workspace {
+	char *slab;
+	size_t size;		// Bytes Carved So Far
+	size_t capacity;	// Bytes In The Slab
+};
+
+void allocWorkspace( Workspace &ws, void (*bind)( Workspace &ws ) );
+void allocWorkspace( Workspace &ws, void (*bind)( Workspace &ws, void *data ), void *data );	// bind Also Gets data
+void freeWorkspace( Workspace &ws );
+void * carve( Workspace &ws, size_t size );
+
+// w x h Cleared Grid Carved From The Workspace
+template <class T> Grid2DT<T> carve2DT( Workspace &ws, int w, int h, int halo=0 ) {
+	Grid2DT<T> grid;
+	size_t size = shape2D(grid,w,h,halo);
+	T *base = (T *)carve(ws,sizeof(T)*size);
+	grid.ptr = NULL;
+	if( base ) attach2D(grid,base);
+	return grid;
+}
+
+// Staggered ( MAC ) Velocity of an n x n Grid
+// face[0] Holds X Velocity On (n+1) x n X Faces, face[1] Y Velocity On n x (n+1) Y Faces
+// Access Bracket u[DIM][X][Y], Copying a MACGrid Copies The Handles
+struct MACGrid {
+	Grid2D face[2];
+	int n;
+	inline Grid2D &operator[]( int dim ) { return face[dim]; }
+	inline const Grid2D &operator[]( int dim ) const { return face[dim]; }
+	
+	// Velocity At The Center of Cell (i,j)
+	inline real centerX( int i, int j ) const { return 0.5*face[0][i][j]+0.5*face[0][i+1][j]; }
+	inline real centerY( int i, int j ) const { return 0.5*face[1][i][j]+0.5*face[1][i][j+1]; }
+};
+
+MACGrid allocMAC( int n, int halo=0 );		// Cleared
+MACGrid carveMAC( Workspace &ws, int n, int halo=0 );	// Cleared
+void freeMAC( MACGrid &u );
+void copyMAC( MACGrid dst, MACGrid src );
+void opMAC( MACGrid dst, MACGrid src1, MACGrid src2, double a, double b ); // dst = a*src1 + b*src2
+
+// Field Storage Layouts
+#define LAYOUT_ROW_MAJOR	0	// Grid2DT Rows
+#define LAYOUT_TILED		1	// Tiled2DT Blocks
+
+// Blocked 2D Field ( Read Only Copy of a Grid2DT Used As a Gather Source )
+// Stored As TILE x TILE Blocks, Each Block Contiguous, So a Stencil Fetched
+// Around An Arbitrary Point Mostly Lands In One Block Instead of Spanning Rows
+// Read With The Same d(i,j) Call As Grid2DT, The Halo Included
+#define TILE_SHIFT		3
+#define TILE			(1<<TILE_SHIFT)
+template <class T> struct Tiled2DT {
+	T *ptr;			// Points To The First Block ( Cell (-halo,-halo) )
+	int w;			// Number of Rows ( X )
+	int h;			// Number of Columns ( Y )
+	int halo;		// Ghost Cells On Each Side
+	int tiles;		// Blocks Per Block Row
+	inline T operator()( int i, int j ) const {
+		i += halo;
+		j += halo;
+		return ptr[(((ptrdiff_t)(i>>TILE_SHIFT)*tiles+(j>>TILE_SHIFT))<<(2*TILE_SHIFT))
+				   +((i&(TILE-1))<<TILE_SHIFT)+(j&(TILE-1))];
+	}
+};
+typedef Tiled2DT<real> Tiled2D;
+
+// w x h Blocked Grid Carved From The Workspace
+template <class T> Tiled2DT<T> carveTiled2DT( Workspace &ws, int w, int h, int halo=0 ) {
+	Tiled2DT<T> grid;
+	grid.w = w;
+	grid.h = h;
+	grid.halo = halo;
+	grid.tiles = (h+2*halo+TILE-1)/TILE;
+	int rows = (w+2*halo+TILE-1)/TILE;
+	grid.ptr = (T *)carve(ws,sizeof(T)*rows*grid.tiles*TILE*TILE);
+	return grid;
+}
+
+// Repack a Grid2DT ( Halo Included, So Fill It First ) Into Blocks
+template <class T> void tile2D( Tiled2DT<T> dst, Grid2DT<T> src ) {
+	const int H = dst.halo;
+	const int rows = (dst.w+2*H+TILE-1)/TILE;
+	OPENMP_FOR
+	for( int ti=0; ti<rows; ti++ ) {
+		for( int tj=0; tj<dst.tiles; tj++ ) {
+			T *block = dst.ptr+(((ptrdiff_t)ti*dst.tiles+tj)<<(2*TILE_SHIFT));
+			for( int di=0; di<TILE; di++ ) {
+				int i = min(ti*TILE+di,dst.w+2*H-1)-H;
+				const T *row = src[i];
+				for( int dj=0; dj<TILE; dj++ ) {
+					int j = min(tj*TILE+dj,dst.h+2*H-1)-H;
+					block[(di<<TILE_SHIFT)+dj] = row[j];
+				}
+			}
+		}
+	}
+}
+
+// 16-bit Fixed Point Storage For Fields That Need ~4 Digits ( The Dye )
+// Values Are Clamped To [0,65535/FIXED16_SCALE], So [0,4) With 6e-5 Resolution
+#define FIXED16_SCALE	16384.0
+typedef unsigned short fixed16;
+typedef Grid2DT<fixed16> Grid2D16;
+
+inline fixed16 toFixed16( real v ) {
+	v = v*(real)FIXED16_SCALE+(real)0.5;
+	return !(v > 0) ? 0 : v >= 65535 ? 65535 : (fixed16)v;
+}
+
+inline real fromFixed16( fixed16 v ) {
+	return v*(real)(1.0/FIXED16_SCALE);
+}
+
+// Read a fixed16 Grid2DT Or Tiled2DT As real With The Usual d(i,j) Call
+template <class G> struct Fixed16 {
+	G grid;
+	inline real operator()( int i, int j ) const { return fromFixed16(grid(i,j)); }
+};
+
+void pack16( Grid2D16 dst, Grid2D src, int w, int h );		// dst = src ( Interior Only )
+void unpack16( Grid2D dst, Grid2D16 src, int w, int h );	// dst = src ( Interior Only )
+
+Grid2D alloc2D( int n, int halo=0 );	// n x (n+1) Cleared Grid
+Grid2D alloc2D( int w, int h, int halo );
+Grid2D carve2D( Workspace &ws, int n, int halo=0 );	// n x (n+1) Cleared Grid
+void copy2D( Grid2D dst, Grid2D src, int n );
+void op2D( Grid2D dst, Grid2D src1, Grid2D src2, double a, double b, int n ); // dst = a*src1 + b*src2
+
+#endif